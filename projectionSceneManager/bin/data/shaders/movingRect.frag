@@ -0,0 +1,12 @@
+// Moving Rect FBO Source: a centred rectangle that pulses between 20% and
+// 100% of the source size. `time` is in degrees of the pulse cycle.
+uniform float time;
+uniform vec4 rectColor;
+
+void main(){
+    float phase = sin(radians(time));
+    float halfSize = 0.5 * mix(0.2, 1.0, phase * 0.5 + 0.5);
+    vec2 d = abs(uv - 0.5);
+    float inside = step(d.x, halfSize) * step(d.y, halfSize);
+    gl_FragColor = rectColor * inside;
+}
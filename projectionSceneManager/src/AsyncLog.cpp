@@ -0,0 +1,230 @@
+#include "AsyncLog.h"
+#include <cstdio>
+#include <cstdarg>
+
+AsyncLog * AsyncLog::_instance = 0;
+
+AsyncLog * AsyncLog::instance(){
+    if(_instance == 0){
+        _instance = new AsyncLog();
+        _instance->startThread();
+    }
+    return _instance;
+}
+
+AsyncLog::AsyncLog(){
+    level = OF_LOG_NOTICE;
+    rateLimit = 20;
+    dropped = 0;
+    suppressedTotal = 0;
+    written = 0;
+}
+
+void AsyncLog::setLevel(ofLogLevel _level){
+    level = _level;
+}
+
+ofLogLevel AsyncLog::getLevel(){
+    return (ofLogLevel)level.load();
+}
+
+void AsyncLog::setRateLimit(int perSecond){
+    rateLimit = perSecond;
+}
+
+uint64_t AsyncLog::getNumWritten(){
+    return written;
+}
+
+uint64_t AsyncLog::getNumDropped(){
+    return dropped;
+}
+
+uint64_t AsyncLog::getNumSuppressed(){
+    return suppressedTotal;
+}
+
+//--------------------------------------------------------------
+void AsyncLog::Record::addString(const char * value, size_t length){
+    if(numArgs >= 6) return;
+    size_t room = sizeof(pool) - poolUsed;
+    if(length > room) length = room;
+    memcpy(pool + poolUsed, value, length);
+    args[numArgs].type = ARG_STRING;
+    args[numArgs].s.offset = poolUsed;
+    args[numArgs].s.length = length;
+    poolUsed += length;
+    numArgs++;
+}
+
+// The ring is created the first time a thread logs and lives as long as
+// the app, like the threads that log
+AsyncLog::ThreadRing * AsyncLog::getRing(){
+    static thread_local ThreadRing * ring = NULL;
+    if(ring == NULL){
+        ring = new ThreadRing();
+        std::lock_guard<std::mutex> guard(ringsMutex);
+        rings.push_back(ring);
+    }
+    return ring;
+}
+
+// Per call site counters in a small table owned by the calling thread, so
+// nothing here is shared with other threads
+bool AsyncLog::admit(const char * format, uint32_t & suppressed){
+    suppressed = 0;
+    int limit = rateLimit.load(std::memory_order_relaxed);
+    if(limit <= 0 || format == NULL) return true;
+
+    ThreadRing * ring = getRing();
+    uint64_t now = ofGetElapsedTimeMicros();
+    Site * site = NULL;
+    size_t hash = ((size_t)format >> 3) & 63;
+    for(int probe = 0; probe < 64; probe++){
+        Site & candidate = ring->sites[(hash + probe) & 63];
+        if(candidate.format == format || candidate.format == NULL){
+            site = &candidate;
+            break;
+        }
+    }
+    // table full, don't limit
+    if(site == NULL) return true;
+
+    if(site->format == NULL || now - site->windowStart >= 1000000){
+        site->format = format;
+        site->windowStart = now;
+        site->count = 0;
+    }
+    if(site->count >= (uint32_t)limit){
+        site->suppressed++;
+        suppressedTotal++;
+        return false;
+    }
+    site->count++;
+    suppressed = site->suppressed;
+    site->suppressed = 0;
+    return true;
+}
+
+void AsyncLog::begin(Record & record, ofLogLevel messageLevel, const char * format, uint32_t suppressed){
+    record.time = ofGetElapsedTimeMicros();
+    record.level = messageLevel;
+    record.format = format;
+    record.suppressed = suppressed;
+    record.numArgs = 0;
+    record.poolUsed = 0;
+}
+
+void AsyncLog::push(Record & record){
+    if(!getRing()->records.push(record)) dropped++;
+}
+
+void AsyncLog::logText(ofLogLevel messageLevel, const string & module, const string & message){
+    if(!accepts(messageLevel)) return;
+    // one record per line, so status reports are not cut at the pool size
+    size_t start = 0;
+    while(start <= message.size()){
+        size_t end = message.find('\n', start);
+        if(end == string::npos) end = message.size();
+        if(end > start || start == 0){
+            Record record;
+            begin(record, messageLevel, module.empty() ? "{}" : "{}: {}", 0);
+            if(!module.empty()) record.add(module);
+            record.addString(message.c_str() + start, end - start);
+            push(record);
+        }
+        start = end + 1;
+    }
+}
+
+//--------------------------------------------------------------
+void AsyncLog::threadedFunction(){
+    while(isThreadRunning()){
+        if(drain() == 0) sleep(10);
+    }
+}
+
+// Takes what every ring holds, puts it in time order and writes it in one go
+int AsyncLog::drain(){
+    batch.clear();
+    {
+        std::lock_guard<std::mutex> guard(ringsMutex);
+        Record record;
+        for(unsigned int i = 0; i < rings.size(); i++){
+            while(rings[i]->records.pop(record)) batch.push_back(record);
+        }
+    }
+    if(batch.empty()) return 0;
+
+    std::stable_sort(batch.begin(), batch.end(), [](const Record & a, const Record & b){ return a.time < b.time; });
+    line.clear();
+    for(unsigned int i = 0; i < batch.size(); i++){
+        format(batch[i], line);
+    }
+    fwrite(line.data(), 1, line.size(), stdout);
+    fflush(stdout);
+    written += batch.size();
+    return batch.size();
+}
+
+void AsyncLog::format(Record & record, string & out){
+    out += "[";
+    out += ofGetLogLevelName(record.level, true);
+    out += "] ";
+
+    int arg = 0;
+    char number[32];
+    for(const char * c = record.format; *c; c++){
+        if(c[0] != '{' || c[1] != '}'){
+            out += *c;
+            continue;
+        }
+        c++;
+        if(arg >= record.numArgs) continue;
+        Record::Arg & a = record.args[arg++];
+        if(a.type == Record::ARG_INT) snprintf(number, sizeof(number), "%lld", (long long)a.i);
+        else if(a.type == Record::ARG_UINT) snprintf(number, sizeof(number), "%llu", (unsigned long long)a.u);
+        else if(a.type == Record::ARG_DOUBLE) snprintf(number, sizeof(number), "%g", a.d);
+        else {
+            out.append(record.pool + a.s.offset, a.s.length);
+            continue;
+        }
+        out += number;
+    }
+    if(record.suppressed > 0){
+        out += " (";
+        out += ofToString(record.suppressed);
+        out += " more suppressed)";
+    }
+    out += "\n";
+}
+
+void AsyncLog::shutdown(){
+    waitForThread(true);
+    drain();
+    if(dropped > 0) fprintf(stdout, "[warning] AsyncLog: %llu messages dropped\n", (unsigned long long)dropped.load());
+    fflush(stdout);
+}
+
+//--------------------------------------------------------------
+// Routes ofLog() into the rings. The message arrives formatted already,
+// but the write still happens on the writer thread.
+class AsyncLogChannel : public ofBaseLoggerChannel {
+    public:
+        void log(ofLogLevel level, const string & module, const string & message){
+            AsyncLog::instance()->logText(level, module, message);
+        }
+        void log(ofLogLevel level, const string & module, const char * format, ...){
+            va_list args;
+            va_start(args, format);
+            log(level, module, format, args);
+            va_end(args);
+        }
+        void log(ofLogLevel level, const string & module, const char * format, va_list args){
+            AsyncLog::instance()->logText(level, module, ofVAArgsToString(format, args));
+        }
+};
+
+void AsyncLog::installChannel(){
+    ofSetLoggerChannel(std::shared_ptr<ofBaseLoggerChannel>(new AsyncLogChannel()));
+}
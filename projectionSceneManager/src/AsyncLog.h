@@ -0,0 +1,169 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <mutex>
+
+// Logging that never blocks the thread calling it.
+//
+// A log call checks the severity, checks the rate limit of its call site
+// and copies the format string pointer and raw arguments into a fixed size
+// record on the calling thread's own lock-free ring. Formatting and the
+// actual write happen on a background writer thread, so a slow serial
+// console or journald only ever holds up that thread.
+//
+//   logNotice("{} changed to {} for {}", sceneIndex, preset, sceneDuration);
+//
+// Each {} takes the next argument. Formats must be string literals, they are
+// read after the call returns. Strings are copied, up to about 200
+// characters per message.
+//
+// Every call site (format string) may log rateLimit messages per second,
+// further ones are counted and reported with the next message that gets
+// through. A full ring drops the message and counts it too.
+//
+// installChannel() sends ofLog() through the same rings, already formatted.
+class AsyncLog : public ofThread {
+    public:
+        struct Record {
+            enum ArgType { ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_STRING };
+            struct Arg {
+                uint8_t type;
+                union {
+                    int64_t i;
+                    uint64_t u;
+                    double d;
+                    struct {
+                        uint16_t offset;
+                        uint16_t length;
+                    } s;
+                };
+            };
+
+            uint64_t time;
+            ofLogLevel level;
+            const char * format;
+            uint32_t suppressed;
+            uint8_t numArgs;
+            uint16_t poolUsed;
+            Arg args[6];
+            char pool[200];
+
+            void addInt(int64_t value){ if(numArgs < 6){ args[numArgs].type = ARG_INT; args[numArgs++].i = value; } }
+            void addUint(uint64_t value){ if(numArgs < 6){ args[numArgs].type = ARG_UINT; args[numArgs++].u = value; } }
+            void addDouble(double value){ if(numArgs < 6){ args[numArgs].type = ARG_DOUBLE; args[numArgs++].d = value; } }
+            void addString(const char * value, size_t length);
+
+            template<typename T>
+            typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type add(T value){ addInt(value); }
+            template<typename T>
+            typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type add(T value){ addUint(value); }
+            template<typename T>
+            typename std::enable_if<std::is_floating_point<T>::value>::type add(T value){ addDouble(value); }
+            void add(const char * value){ addString(value, strlen(value)); }
+            void add(const string & value){ addString(value.c_str(), value.size()); }
+        };
+
+        static AsyncLog * instance();
+
+        void setLevel(ofLogLevel _level);
+        ofLogLevel getLevel();
+        void setRateLimit(int perSecond);
+        // sends every ofLog() call through the writer thread
+        void installChannel();
+        // writes out everything logged so far and stops the writer thread
+        void shutdown();
+
+        uint64_t getNumWritten();
+        uint64_t getNumDropped();
+        uint64_t getNumSuppressed();
+
+        // fast rejection before any argument is touched
+        bool accepts(ofLogLevel messageLevel){
+            return messageLevel >= level.load(std::memory_order_relaxed);
+        }
+
+        template<typename... Args>
+        void log(ofLogLevel messageLevel, const char * format, const Args &... args){
+            uint32_t suppressed;
+            if(!admit(format, suppressed)) return;
+            Record record;
+            begin(record, messageLevel, format, suppressed);
+            int unpack[] = { 0, (record.add(args), 0)... };
+            (void)unpack;
+            push(record);
+        }
+
+        // an already formatted message, used by the ofLog channel
+        void logText(ofLogLevel messageLevel, const string & module, const string & message);
+
+    private:
+        struct Site {
+            const char * format;
+            uint64_t windowStart;
+            uint32_t count;
+            uint32_t suppressed;
+        };
+
+        // one per logging thread, only that thread pushes and looks at sites
+        struct ThreadRing {
+            ThreadRing() : records(512) {
+                memset(sites, 0, sizeof(sites));
+            }
+            SpscQueue<Record> records;
+            Site sites[64];
+        };
+
+        AsyncLog();
+
+        ThreadRing * getRing();
+        bool admit(const char * format, uint32_t & suppressed);
+        void begin(Record & record, ofLogLevel messageLevel, const char * format, uint32_t suppressed);
+        void push(Record & record);
+
+        void threadedFunction();
+        int drain();
+        void format(Record & record, string & out);
+
+        static AsyncLog * _instance;
+
+        std::atomic<int> level;
+        std::atomic<int> rateLimit;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> suppressedTotal;
+        uint64_t written;
+
+        std::mutex ringsMutex;
+        vector<ThreadRing *> rings;
+
+        // writer side scratch, reused between batches
+        vector<Record> batch;
+        string line;
+};
+
+template<typename... Args>
+void logVerbose(const char * format, const Args &... args){
+    AsyncLog * log = AsyncLog::instance();
+    if(log->accepts(OF_LOG_VERBOSE)) log->log(OF_LOG_VERBOSE, format, args...);
+}
+
+template<typename... Args>
+void logNotice(const char * format, const Args &... args){
+    AsyncLog * log = AsyncLog::instance();
+    if(log->accepts(OF_LOG_NOTICE)) log->log(OF_LOG_NOTICE, format, args...);
+}
+
+template<typename... Args>
+void logWarning(const char * format, const Args &... args){
+    AsyncLog * log = AsyncLog::instance();
+    if(log->accepts(OF_LOG_WARNING)) log->log(OF_LOG_WARNING, format, args...);
+}
+
+template<typename... Args>
+void logError(const char * format, const Args &... args){
+    AsyncLog * log = AsyncLog::instance();
+    if(log->accepts(OF_LOG_ERROR)) log->log(OF_LOG_ERROR, format, args...);
+}
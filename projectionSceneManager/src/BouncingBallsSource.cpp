@@ -1,79 +1,179 @@
 #include "BouncingBallsSource.h"
 
+// Round point sprites: the vertex stage sizes the point, the fragment stage cuts the circle
+static string ballVertProgrammable =
+    "attribute vec4 position;\n"
+    "uniform mat4 modelViewProjectionMatrix;\n"
+    "uniform float pointSize;\n"
+    "void main(){\n"
+    "    gl_PointSize = pointSize;\n"
+    "    gl_Position = modelViewProjectionMatrix * position;\n"
+    "}\n";
+
+static string ballFragProgrammable =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform vec4 ballColor;\n"
+    "void main(){\n"
+    "    if(length(gl_PointCoord - vec2(0.5)) > 0.5) discard;\n"
+    "    gl_FragColor = ballColor;\n"
+    "}\n";
+
+static string ballVertFixed =
+    "#version 120\n"
+    "uniform float pointSize;\n"
+    "void main(){\n"
+    "    gl_PointSize = pointSize;\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+    "}\n";
+
+static string ballFragFixed =
+    "#version 120\n"
+    "uniform vec4 ballColor;\n"
+    "void main(){\n"
+    "    if(length(gl_PointCoord - vec2(0.5)) > 0.5) discard;\n"
+    "    gl_FragColor = ballColor;\n"
+    "}\n";
+
+BouncingBallsSource::BouncingBallsSource(){
+    ballCount = 50;
+    ballRadius = 5;
+    startTime = 0;
+}
+
 void BouncingBallsSource::setup(){
 	// Give our source a decent name
     name = "Bouncing Balls FBO Source";
 
-	// Allocate our FBO source, decide how big it should be
-    allocate(10, 10);
+	// Allocate our FBO source, decide how big it should be.
+	// Balls spawn and bounce inside the FBO, so it has to be a good deal bigger than a ball.
+    allocate(500, 500);
 
-    setupBalls();
+    // settings.json, --set and remote cues change the count while running
+    Settings::instance()->addParameter(name + ":count", &ballCount, 0, 100000, [this](){ setupBalls(); });
 
-    //if you want to draw something inside setup you need to make calls to this->beginFbo() / this->endFbo as below
-    //this->beginFbo();
-    ofClear(255,0,0);
-   // this->endFbo();
+    setupShader();
+    setupBalls();
 }
 
 void BouncingBallsSource::setName(string _name){
     name = _name;
 }
 
+// Can be called at any time, existing balls keep moving
+void BouncingBallsSource::setBallCount(int count){
+    ballCount = MAX(0, count);
+    if(fbo != NULL) setupBalls();
+}
+
 // Don't do any drawing here
 void BouncingBallsSource::update(){
+    TRACE_ZONE("BouncingBallsSource::update");
     updateBalls();
 }
 
 void BouncingBallsSource::reset(){
     //initialise time at the start of source
-    startTime = ofGetElapsedTimeMillis();
+    startTime = TimerWheel::instance()->now();
     //ofClear(0); // uncomment if you want canvas to be reset on the buffer when fbo source is called again
 }
 
 // No need to take care of fbo.begin() and fbo.end() here.
 // All within draw() is being rendered into fbo;
 void BouncingBallsSource::draw(){
-    ofPushStyle();
+    TRACE_ZONE("BouncingBallsSource::draw");
+    DrawStatsScope drawStats(name);
+    counted::ofPushStyle();
     ofClear(0); // remove if you never want to update the background
 
     //if a certain amount of time has passed (in millis), do something (change color in this case)
-    if (ofGetElapsedTimeMillis() - startTime < 500) ballColor = ofColor(255,0,0);
-    else if (ofGetElapsedTimeMillis() - startTime < 1000) ballColor = ofColor(0,255,0);
-    else if (ofGetElapsedTimeMillis() - startTime < 1500) ballColor = ofColor(255);
+    uint64_t elapsed = TimerWheel::instance()->now() - startTime;
+    if (elapsed < 500) ballColor = ofColor(255,0,0);
+    else if (elapsed < 1000) ballColor = ofColor(0,255,0);
+    else if (elapsed < 1500) ballColor = ofColor(255);
 
-    //something happening every 60 frames using modulo
-//    if (ofGetFrameNum()%60==0) {
-//        ballColor = ofColor(ofRandom(0, 255),ofRandom(0,255),ofRandom(0,255));
-//    }
+    drawBalls(0,0); // Fill FBO with RED balls
 
-    drawBalls(0,0,fbo->getWidth(), fbo->getHeight()); // Fill FBO with RED balls
-
-    ofPopStyle();
+    counted::ofPopStyle();
 }
 
 //================================================================
+void BouncingBallsSource::setupShader(){
+    bool programmable = ofIsGLProgrammableRenderer();
+    ballShader.setupShaderFromSource(GL_VERTEX_SHADER, programmable ? ballVertProgrammable : ballVertFixed);
+    ballShader.setupShaderFromSource(GL_FRAGMENT_SHADER, programmable ? ballFragProgrammable : ballFragFixed);
+    if(programmable) ballShader.bindDefaults();
+    ballShader.linkProgram();
+}
+
 void BouncingBallsSource::setupBalls() {
-    ofSetCircleResolution(50);
-    for (int i=0; i<50; i++){
-        ofVec2f randomLocation = ofVec2f(ofRandom(0,ofGetWidth()),ofRandom(0,ofGetHeight()));
-        locations.push_back(randomLocation);
-        ofVec2f randomSpeed = ofVec2f(ofRandom(-3,3),ofRandom(-3,3));
-        speeds.push_back(randomSpeed);
+    float minX = ballRadius, maxX = MAX(ballRadius, fbo->getWidth() - ballRadius);
+    float minY = ballRadius, maxY = MAX(ballRadius, fbo->getHeight() - ballRadius);
+
+    int oldCount = posX.size();
+    posX.resize(ballCount);
+    posY.resize(ballCount);
+    speedX.resize(ballCount);
+    speedY.resize(ballCount);
+    for (int i=oldCount; i<ballCount; i++){
+        posX[i] = ofRandom(minX, maxX);
+        posY[i] = ofRandom(minY, maxY);
+        speedX[i] = ofRandom(-3,3);
+        speedY[i] = ofRandom(-3,3);
     }
+
+    ballMesh.clear();
+    ballMesh.setMode(OF_PRIMITIVE_POINTS);
+    ballMesh.setUsage(GL_STREAM_DRAW);
+    ballMesh.getVertices().resize(ballCount);
 }
 
 void BouncingBallsSource::updateBalls(){
-    // Move balls
-    for(int i = 0; i < locations.size(); i++){
-        locations[i] = locations[i] + speeds[i];
-        if (locations[i].x<5 || locations[i].x>fbo->getWidth()-5) speeds[i].x*=-1;
-        if (locations[i].y<5 || locations[i].y>fbo->getHeight()-5) speeds[i].y*=-1;
+    float minX = ballRadius, maxX = fbo->getWidth() - ballRadius;
+    float minY = ballRadius, maxY = fbo->getHeight() - ballRadius;
+    float * px = posX.data();
+    float * py = posY.data();
+    float * vx = speedX.data();
+    float * vy = speedY.data();
+    int n = posX.size();
+
+    // Move balls. No branches so the compiler can vectorize this:
+    // a ball that crossed a wall is clamped back and its speed mirrored.
+    for(int i = 0; i < n; i++){
+        float x = px[i] + vx[i];
+        float y = py[i] + vy[i];
+        float cx = MIN(MAX(x, minX), maxX);
+        float cy = MIN(MAX(y, minY), maxY);
+        vx[i] = (cx != x) ? -vx[i] : vx[i];
+        vy[i] = (cy != y) ? -vy[i] : vy[i];
+        px[i] = cx;
+        py[i] = cy;
     }
-}
 
-void BouncingBallsSource::drawBalls(int x, int y, int w, int h){
-    ofSetColor(ballColor);
-    for(int i = 0; i < locations.size(); i++){     
-        ofDrawCircle(locations[i], 5);
+    vector<ofVec3f> & vertices = ballMesh.getVertices();
+    for(int i = 0; i < n; i++){
+        vertices[i].set(px[i], py[i], 0);
     }
 }
+
+void BouncingBallsSource::drawBalls(int x, int y){
+    counted::ofPushMatrix();
+    counted::ofTranslate(x, y);
+#ifndef TARGET_OPENGLES
+    // GL ES always takes gl_PointSize from the shader, desktop GL only when
+    // asked to, and the fixed function pipeline needs point sprites on too
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    if(!ofIsGLProgrammableRenderer()) glEnable(GL_POINT_SPRITE);
+#endif
+    ballShader.begin();
+    ballShader.setUniform1f("pointSize", ballRadius * 2);
+    ballShader.setUniform4f("ballColor", ballColor.r/255.0, ballColor.g/255.0, ballColor.b/255.0, ballColor.a/255.0);
+    counted::draw(ballMesh);
+    ballShader.end();
+#ifndef TARGET_OPENGLES
+    if(!ofIsGLProgrammableRenderer()) glDisable(GL_POINT_SPRITE);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+#endif
+    counted::ofPopMatrix();
+}
@@ -2,21 +2,36 @@
 
 #include "ofMain.h"
 #include "FboSource.h"
+#include "Trace.h"
+#include "DrawStats.h"
+#include "TimerWheel.h"
+#include "Settings.h"
 
 class BouncingBallsSource : public ofx::piMapper::FboSource {
 	public:
+        BouncingBallsSource();
+
         void setup();
 		void update();
 		void draw();
         void setName(string);
+        void setBallCount(int count);
         void setupBalls();
+        void setupShader();
         void updateBalls();
         void reset();
-        void drawBalls(int x, int y, int w, int h);
+        void drawBalls(int x, int y);
+
+        // Ball state as structure of arrays so the update loop vectorizes
+        vector<float> posX, posY;
+        vector<float> speedX, speedY;
+        int ballCount;
+        float ballRadius;
 
-        vector <ofVec2f> locations;
-        vector <ofVec2f> speeds;
+        // All balls go to the GPU as one point sprite draw
+        ofVboMesh ballMesh;
+        ofShader ballShader;
 
-        int startTime;
+        uint64_t startTime;
         ofColor ballColor;
 };
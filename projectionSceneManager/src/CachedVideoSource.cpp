@@ -0,0 +1,142 @@
+#include "CachedVideoSource.h"
+
+CachedVideoSource::CachedVideoSource(){
+    cacheScale = 0.5;
+    decoding = false;
+    cacheable = true;
+    lastDecodedFrame = -1;
+    shownFrame = -1;
+    startTime = 0;
+}
+
+void CachedVideoSource::setup(string _videoPath, string _name, int width, int height, float _cacheScale){
+    videoPath = _videoPath;
+    name = _name;
+    cacheScale = ofClamp(_cacheScale, 0.05, 1);
+    allocate(width, height);
+    startTime = TimerWheel::instance()->now();
+}
+
+void CachedVideoSource::setName(string _name){
+    name = _name;
+}
+
+void CachedVideoSource::reset(){
+    //restart the loop from its first frame whenever the source is assigned
+    startTime = TimerWheel::instance()->now();
+    shownFrame = -1;
+}
+
+void CachedVideoSource::exit(){
+    stopDecoding();
+}
+
+bool CachedVideoSource::isPlayingFromCache(){
+    return !decoding && VideoFrameCache::instance()->isComplete(videoPath);
+}
+
+// Don't do any drawing here
+void CachedVideoSource::update(){
+    TRACE_ZONE("CachedVideoSource::update");
+    VideoFrameCache * cache = VideoFrameCache::instance();
+
+    if(decoding){
+        player.update();
+        if(player.isFrameNew()) captureFrame();
+        return;
+    }
+
+    // spread the captured frames over the length of the clip, frames the
+    // decoder dropped must not make the loop shorter
+    int numFrames = cache->getNumFrames(videoPath);
+    float duration = cache->getDuration(videoPath);
+    int frame = 0;
+    if(numFrames > 0 && duration > 0){
+        uint64_t elapsed = TimerWheel::instance()->now() - startTime;
+        frame = (int)(elapsed * numFrames / (duration * 1000.0f)) % numFrames;
+    }
+
+    // the cache counts a hit per frame shown, not per update
+    if(frame == shownFrame && cache->isComplete(videoPath)) return;
+    ofPixels * pixels = cache->getFrame(videoPath, frame);
+    if(pixels == NULL){
+        // never decoded or evicted since, go through the decoder once more
+        startDecoding();
+        return;
+    }
+    if(!frameTexture.isAllocated() || frameTexture.getWidth() != pixels->getWidth()){
+        frameTexture.allocate(*pixels);
+    }
+    frameTexture.loadData(*pixels);
+    shownFrame = frame;
+}
+
+// No need to take care of fbo.begin() and fbo.end() here.
+// All within draw() is being rendered into fbo;
+void CachedVideoSource::draw(){
+    TRACE_ZONE("CachedVideoSource::draw");
+    DrawStatsScope drawStats(name);
+    ofClear(0);
+    if(decoding){
+        // first pass through the clip, show the decoder output directly
+        counted::draw(player, 0, 0, fbo->getWidth(), fbo->getHeight());
+    } else if(shownFrame >= 0){
+        // the cached frames are downscaled, let the texture sampler scale them back up
+        counted::draw(frameTexture, 0, 0, fbo->getWidth(), fbo->getHeight());
+    }
+}
+
+//================================================================
+void CachedVideoSource::startDecoding(){
+    if(!player.load(videoPath)){
+        ofLogError("CachedVideoSource") << "could not load " << videoPath;
+        return;
+    }
+    player.setVolume(0);
+    player.setLoopState(OF_LOOP_NORMAL);
+    player.play();
+
+    VideoFrameCache::instance()->beginClip(videoPath, player.getDuration());
+    decoding = true;
+    cacheable = true;
+    lastDecodedFrame = -1;
+    shownFrame = -1;
+}
+
+void CachedVideoSource::stopDecoding(){
+    if(!decoding) return;
+    player.close();
+    decoding = false;
+}
+
+void CachedVideoSource::captureFrame(){
+    VideoFrameCache * cache = VideoFrameCache::instance();
+    int frame = player.getCurrentFrame();
+
+    // shown from the decoder, whether it goes into the cache or not
+    cache->countDecodedFrame(videoPath);
+    if(!cacheable) return;
+
+    // the decoder wrapped around: one full loop is in the cache
+    if(frame < lastDecodedFrame){
+        cache->endClip(videoPath);
+        stopDecoding();
+        startTime = TimerWheel::instance()->now();
+        ofLogNotice("CachedVideoSource") << name << ": cached " << cache->getNumFrames(videoPath) << " frames";
+        return;
+    }
+    lastDecodedFrame = frame;
+
+    ofPixels & pixels = player.getPixels();
+    size_t w = MAX(1, pixels.getWidth() * cacheScale);
+    size_t h = MAX(1, pixels.getHeight() * cacheScale);
+    if(scaled.getWidth() != w || scaled.getHeight() != h){
+        scaled.allocate(w, h, pixels.getPixelFormat());
+    }
+    pixels.resizeTo(scaled, OF_INTERPOLATE_BILINEAR);
+    if(!cache->addFrame(videoPath, scaled)){
+        // does not fit in the budget, keep streaming from the decoder instead
+        cacheable = false;
+        ofLogWarning("CachedVideoSource") << name << ": clip does not fit in the video cache budget, playing uncached";
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FboSource.h"
+#include "Trace.h"
+#include "DrawStats.h"
+#include "TimerWheel.h"
+#include "VideoFrameCache.h"
+
+// Looping video source that decodes its clip once and then plays the loop
+// from the VideoFrameCache. If the clip gets evicted it is decoded again.
+class CachedVideoSource : public ofx::piMapper::FboSource {
+    public:
+        CachedVideoSource();
+
+        void setup(string _videoPath, string _name, int width, int height, float _cacheScale = 0.5);
+        void update();
+        void draw();
+        void reset();
+        void exit();
+        void setName(string _name);
+
+        bool isPlayingFromCache();
+
+    private:
+        void startDecoding();
+        void stopDecoding();
+        void captureFrame();
+
+        string videoPath;
+        float cacheScale;
+        ofVideoPlayer player;
+        bool decoding;
+        bool cacheable;
+        int lastDecodedFrame;
+
+        ofPixels scaled;
+        ofTexture frameTexture;
+        int shownFrame;
+        uint64_t startTime;
+};
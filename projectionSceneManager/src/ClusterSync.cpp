@@ -0,0 +1,272 @@
+#include "ClusterSync.h"
+#include <unistd.h>
+#include <cstring>
+
+static const uint32_t clusterMagic = 0x50534d53; // "PSMS"
+static const uint8_t clusterVersion = 1;
+static const uint8_t packetBeacon = 1;
+static const uint8_t packetReport = 2;
+static const uint64_t beaconInterval = 50000; // micros
+static const unsigned int windowSize = 16;
+static const int cueMismatchLimit = 3;
+
+ClusterSync::ClusterSync(){
+    role = ROLE_NONE;
+    connected = false;
+    offset = 0;
+    synced = false;
+    stepped = false;
+    lastApplied = 0;
+    cueMismatches = 0;
+    seq = 0;
+    lastBeacon = 0;
+    lastLog = 0;
+    slewRate = 5000;
+    stepThreshold = 250000;
+}
+
+ClusterSync::~ClusterSync(){
+    exit();
+}
+
+ClusterSync::Role ClusterSync::roleFromString(string role){
+    if(role == "leader") return ROLE_LEADER;
+    if(role == "follower") return ROLE_FOLLOWER;
+    return ROLE_NONE;
+}
+
+bool ClusterSync::setup(Role _role, string group, int port, string _nodeId, string logPath){
+    role = _role;
+    if(role == ROLE_NONE) return true;
+
+    nodeId = _nodeId.empty() ? "node-" + ofToString(getpid()) : _nodeId;
+
+    // every instance on the machine binds the same port
+    receiver.Create();
+    receiver.SetReuseAddress(true);
+    bool bound = receiver.BindMcast((char *)group.c_str(), port);
+    receiver.SetTimeoutReceive(1);
+
+    sender.Create();
+    sender.SetReuseAddress(true);
+    sender.SetTTL(1);
+    bool connectedOut = sender.ConnectMcast((char *)group.c_str(), port);
+
+    connected = bound && connectedOut;
+    if(!connected){
+        ofLogError("ClusterSync") << nodeId << ": could not join " << group << ":" << port << ", running standalone";
+        role = ROLE_NONE;
+        return false;
+    }
+
+    if(role == ROLE_LEADER && !logPath.empty()){
+        logFile.open(ofToDataPath(logPath, true).c_str(), ios::out | ios::app);
+        logFile << "leader_ms,follower,seq,offset_us,rtt_us" << endl;
+    }
+
+    ofLogNotice("ClusterSync") << nodeId << ": " << (role == ROLE_LEADER ? "leading" : "following")
+        << " on " << group << ":" << port;
+    startThread();
+    return true;
+}
+
+void ClusterSync::exit(){
+    if(!connected) return;
+    waitForThread(true);
+    sender.Close();
+    receiver.Close();
+    if(logFile.is_open()) logFile.close();
+    connected = false;
+}
+
+uint64_t ClusterSync::now(){
+    if(role == ROLE_NONE) return ofGetElapsedTimeMillis();
+    int64_t time = (int64_t)ofGetElapsedTimeMicros() + offset.load();
+    return time > 0 ? time / 1000 : 0;
+}
+
+bool ClusterSync::takeStep(){
+    bool step = stepped;
+    stepped = false;
+    return step;
+}
+
+ClusterSync::Role ClusterSync::getRole(){
+    return role;
+}
+
+//--------------------------------------------------------------
+// Receive thread: stamps packets the moment they arrive and answers
+// beacons right away, so neither side waits for a frame
+void ClusterSync::threadedFunction(){
+    Packet packet;
+    while(isThreadRunning()){
+        int received = receiver.Receive((char *)&packet, sizeof(packet));
+        uint64_t arrival = ofGetElapsedTimeMicros();
+        if(received != (int)sizeof(packet)) continue;
+        if(packet.magic != clusterMagic || packet.version != clusterVersion) continue;
+
+        if(role == ROLE_FOLLOWER && packet.type == packetBeacon) handleBeacon(packet, arrival);
+        else if(role == ROLE_LEADER && packet.type == packetReport) handleReport(packet, arrival);
+    }
+}
+
+void ClusterSync::handleBeacon(Packet & packet, uint64_t arrival){
+    Sample sample;
+    sample.leaderTime = packet.time;
+    sample.arrival = arrival;
+    sample.cueIndex = packet.cueIndex;
+    sample.cueEnd = packet.cueEnd;
+    lock();
+    samples.push_back(sample);
+    unlock();
+
+    Packet report = packet;
+    report.type = packetReport;
+    report.echo = packet.time;
+    report.time = arrival + offset.load();
+    strncpy(report.node, nodeId.c_str(), sizeof(report.node) - 1);
+    report.node[sizeof(report.node) - 1] = 0;
+    sender.Send((const char *)&report, sizeof(report));
+}
+
+// The report left the follower half a round trip after the beacon left
+// here, if the clocks agree its time is echo + rtt / 2
+void ClusterSync::handleReport(Packet & packet, uint64_t arrival){
+    string node(packet.node, strnlen(packet.node, sizeof(packet.node)));
+    int64_t rtt = (int64_t)arrival - (int64_t)packet.echo;
+    int64_t followerOffset = (int64_t)packet.time - (int64_t)(packet.echo + rtt / 2);
+
+    lock();
+    map<string, FollowerStats>::iterator it = followers.find(node);
+    if(it == followers.end()){
+        FollowerStats fresh;
+        fresh.minOffset = fresh.maxOffset = followerOffset;
+        fresh.sumAbsOffset = 0;
+        fresh.count = 0;
+        it = followers.insert(make_pair(node, fresh)).first;
+    }
+    FollowerStats & stats = it->second;
+    stats.lastSeen = arrival;
+    stats.offset = followerOffset;
+    stats.rtt = rtt;
+    stats.minOffset = MIN(stats.minOffset, followerOffset);
+    stats.maxOffset = MAX(stats.maxOffset, followerOffset);
+    stats.sumAbsOffset += fabs((double)followerOffset);
+    stats.count++;
+    if(logFile.is_open()){
+        logFile << arrival / 1000 << "," << node << "," << packet.seq << "," << followerOffset << "," << rtt << "\n";
+    }
+    unlock();
+}
+
+//--------------------------------------------------------------
+void ClusterSync::update(SceneManager & scenes){
+    if(role == ROLE_LEADER){
+        uint64_t time = ofGetElapsedTimeMicros();
+        if(time - lastBeacon >= beaconInterval){
+            lastBeacon = time;
+            sendBeacon(scenes);
+        }
+        if(time - lastLog >= 5000000){
+            lastLog = time;
+            logFollowers();
+        }
+    } else if(role == ROLE_FOLLOWER){
+        applySamples(scenes);
+    }
+}
+
+void ClusterSync::sendBeacon(SceneManager & scenes){
+    Packet packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = clusterMagic;
+    packet.version = clusterVersion;
+    packet.type = packetBeacon;
+    packet.seq = seq++;
+    packet.cueIndex = scenes.sceneIndex;
+    packet.cueEnd = scenes.sceneDuration;
+    packet.time = ofGetElapsedTimeMicros();
+    strncpy(packet.node, nodeId.c_str(), sizeof(packet.node) - 1);
+    sender.Send((const char *)&packet, sizeof(packet));
+}
+
+void ClusterSync::applySamples(SceneManager & scenes){
+    vector<Sample> fresh;
+    lock();
+    fresh.swap(samples);
+    unlock();
+
+    uint64_t time = ofGetElapsedTimeMicros();
+    float elapsed = lastApplied > 0 ? (time - lastApplied) / 1000000.0f : 0;
+    lastApplied = time;
+
+    for(unsigned int i = 0; i < fresh.size(); i++){
+        // network delay only ever makes a beacon look older
+        window.push_back((int64_t)fresh[i].leaderTime - (int64_t)fresh[i].arrival);
+        if(window.size() > windowSize) window.pop_front();
+    }
+    if(window.empty()) return;
+
+    int64_t target = *max_element(window.begin(), window.end());
+    int64_t error = target - offset.load();
+    if(!synced || llabs(error) > stepThreshold){
+        offset = target;
+        window.clear();
+        ofLogNotice("ClusterSync") << nodeId << ": clock stepped by " << error / 1000 << "ms";
+        synced = true;
+        stepped = true;
+        // the leader's cue end is only comparable once the wheel is rebased
+        return;
+    } else {
+        int64_t maxStep = slewRate * elapsed;
+        offset += MAX(-maxStep, MIN(error, maxStep));
+    }
+
+    // follow the leader's cue once the disagreement is not just a boundary
+    // crossed a moment earlier or later than the leader
+    if(!fresh.empty()){
+        Sample & last = fresh.back();
+        if(last.cueIndex != scenes.sceneIndex){
+            if(++cueMismatches >= cueMismatchLimit){
+                scenes.jumpToScene(last.cueIndex, last.cueEnd);
+                cueMismatches = 0;
+            }
+        } else {
+            cueMismatches = 0;
+        }
+    }
+}
+
+void ClusterSync::logFollowers(){
+    lock();
+    for(map<string, FollowerStats>::iterator it = followers.begin(); it != followers.end(); ++it){
+        FollowerStats & stats = it->second;
+        ofLogNotice("ClusterSync") << it->first << ": offset " << stats.offset << "us"
+            << " (min " << stats.minOffset << ", max " << stats.maxOffset
+            << ", mean abs " << (int64_t)(stats.count > 0 ? stats.sumAbsOffset / stats.count : 0) << ")"
+            << " rtt " << stats.rtt << "us, " << stats.count << " reports";
+        stats.minOffset = stats.maxOffset = stats.offset;
+        stats.sumAbsOffset = 0;
+        stats.count = 0;
+    }
+    if(logFile.is_open()) logFile.flush();
+    unlock();
+}
+
+string ClusterSync::getStatusString(){
+    stringstream ss;
+    if(role == ROLE_NONE){
+        ss << "cluster: standalone";
+    } else if(role == ROLE_LEADER){
+        lock();
+        ss << "cluster: leading " << followers.size() << " followers";
+        for(map<string, FollowerStats>::iterator it = followers.begin(); it != followers.end(); ++it){
+            ss << "\n  " << it->first << " offset " << it->second.offset << "us rtt " << it->second.rtt << "us";
+        }
+        unlock();
+    } else {
+        ss << "cluster: following, offset " << offset.load() / 1000 << "ms" << (synced ? "" : " (waiting for leader)");
+    }
+    return ss.str();
+}
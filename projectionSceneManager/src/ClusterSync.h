@@ -0,0 +1,116 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxNetwork.h"
+#include "SceneManager.h"
+#include <atomic>
+
+// Keeps the scene and simulation clocks of several instances together.
+//
+// The leader multicasts a beacon with its clock and current cue 20 times a
+// second. Followers receive beacons on a thread that stamps them on
+// arrival, answer each with a report, and on the main thread slew their
+// clock offset towards the leader's. Small errors are corrected by at most
+// slewRate, so playback never visibly jumps. Errors above stepThreshold
+// (a follower started late, or the leader restarted) are stepped at once.
+// A follower also takes over the leader's cue when it disagrees on
+// several beacons in a row.
+//
+// The leader turns the reports into per follower offsets and round trips,
+// logged every few seconds and optionally to a CSV file.
+//
+// now() replaces ofGetElapsedTimeMillis() as the input of the TimerWheel.
+// Without a role it is exactly that. Several instances can run on one
+// machine, the sockets share the port.
+class ClusterSync : public ofThread {
+    public:
+        enum Role {
+            ROLE_NONE,
+            ROLE_LEADER,
+            ROLE_FOLLOWER
+        };
+
+        ClusterSync();
+        ~ClusterSync();
+
+        bool setup(Role _role, string group, int port, string _nodeId, string logPath = "");
+        void exit();
+
+        uint64_t now();
+        void update(SceneManager & scenes);
+        // true once after the clock was stepped, the TimerWheel is then
+        // rebased to now() instead of advanced through the gap
+        bool takeStep();
+
+        Role getRole();
+        string getStatusString();
+
+        static Role roleFromString(string role);
+
+        // Follower tuning
+        float slewRate;             // max correction, micros per second
+        int64_t stepThreshold;      // micros
+
+    private:
+        // Fixed layout, both ends are little endian (Pi and x86)
+        struct Packet {
+            uint32_t magic;
+            uint8_t version;
+            uint8_t type;
+            uint16_t reserved;
+            uint32_t seq;
+            int32_t cueIndex;
+            int64_t cueEnd;         // millis, leader clock
+            uint64_t time;          // micros: leader clock in beacons, follower clock in reports
+            uint64_t echo;          // reports: the beacon time they answer
+            char node[16];
+        };
+
+        struct Sample {
+            uint64_t leaderTime;
+            uint64_t arrival;       // local micros
+            int cueIndex;
+            int64_t cueEnd;
+        };
+
+        struct FollowerStats {
+            uint64_t lastSeen;
+            int64_t offset;
+            int64_t minOffset, maxOffset;
+            int64_t rtt;
+            double sumAbsOffset;
+            int count;
+        };
+
+        void threadedFunction();
+        void handleBeacon(Packet & packet, uint64_t arrival);
+        void handleReport(Packet & packet, uint64_t arrival);
+        void sendBeacon(SceneManager & scenes);
+        void applySamples(SceneManager & scenes);
+        void logFollowers();
+
+        Role role;
+        string nodeId;
+        ofxUDPManager sender;
+        ofxUDPManager receiver;
+        bool connected;
+
+        // cluster time = local micros + offset, only the leader's is always 0
+        std::atomic<int64_t> offset;
+        bool synced;
+        bool stepped;
+        uint64_t lastApplied;
+
+        // written by the receive thread, taken under lock
+        vector<Sample> samples;
+        map<string, FollowerStats> followers;
+
+        // the least delayed of the recent beacons is the best estimate
+        deque<int64_t> window;
+        int cueMismatches;
+
+        uint32_t seq;
+        uint64_t lastBeacon;
+        uint64_t lastLog;
+        ofstream logFile;
+};
@@ -0,0 +1,177 @@
+#include "CueControl.h"
+#include <cstring>
+
+CueControlServer::CueControlServer(){
+    queue = NULL;
+    listening = false;
+    received = 0;
+    rejected = 0;
+    dropped = 0;
+}
+
+CueControlServer::~CueControlServer(){
+    exit();
+}
+
+bool CueControlServer::setup(int port, CueQueue * _queue){
+    queue = _queue;
+    socket.Create();
+    socket.SetReuseAddress(true);
+    if(!socket.Bind(port)){
+        ofLogError("CueControlServer") << "could not listen on udp port " << port;
+        return false;
+    }
+    socket.SetTimeoutReceive(1);
+    listening = true;
+    ofLogNotice("CueControlServer") << "listening for cues on udp port " << port;
+    startThread();
+    return true;
+}
+
+void CueControlServer::exit(){
+    if(!listening) return;
+    waitForThread(true);
+    socket.Close();
+    listening = false;
+}
+
+int CueControlServer::getNumReceived(){
+    return received;
+}
+
+int CueControlServer::getNumRejected(){
+    return rejected;
+}
+
+int CueControlServer::getNumDropped(){
+    return dropped;
+}
+
+void CueControlServer::threadedFunction(){
+    char buffer[1024];
+    while(isThreadRunning()){
+        int size = socket.Receive(buffer, sizeof(buffer));
+        if(size <= 0) continue;
+
+        CueCommand command;
+        command.received = ofGetElapsedTimeMicros();
+        if(!parse(buffer, size, command)){
+            rejected++;
+            continue;
+        }
+        received++;
+        // the main thread is far behind, losing a cue beats blocking here
+        if(!queue->push(command)) dropped++;
+    }
+}
+
+//--------------------------------------------------------------
+bool CueControlServer::parse(const char * data, int size, CueCommand & command){
+    memset(command.source, 0, sizeof(command.source));
+    memset(command.parameter, 0, sizeof(command.parameter));
+    command.index = 0;
+    command.value = 0;
+    if(size > 0 && data[0] == '/') return parseOsc(data, size, command);
+    return parseText(string(data, size), command);
+}
+
+// OSC strings are zero terminated and padded to 4 bytes
+static bool readOscString(const char * data, int size, int & pos, string & out){
+    int start = pos;
+    while(pos < size && data[pos] != 0) pos++;
+    if(pos >= size) return false;
+    out.assign(data + start, pos - start);
+    pos = (pos + 4) & ~3;
+    return pos <= size;
+}
+
+// OSC numbers are big endian
+static bool readOscInt(const char * data, int size, int & pos, int32_t & out){
+    if(pos + 4 > size) return false;
+    const unsigned char * b = (const unsigned char *)data + pos;
+    out = (int32_t)((uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | (uint32_t)b[3]);
+    pos += 4;
+    return true;
+}
+
+// Only single messages, lighting desks send one cue per packet
+bool CueControlServer::parseOsc(const char * data, int size, CueCommand & command){
+    int pos = 0;
+    string address, tags;
+    if(!readOscString(data, size, pos, address)) return false;
+    if(pos < size && !readOscString(data, size, pos, tags)) return false;
+    if(tags.empty() || tags[0] != ',') tags = ",";
+
+    vector<string> strings;
+    vector<float> numbers;
+    for(unsigned int t = 1; t < tags.size(); t++){
+        if(tags[t] == 'i'){
+            int32_t value;
+            if(!readOscInt(data, size, pos, value)) return false;
+            numbers.push_back(value);
+        } else if(tags[t] == 'f'){
+            int32_t bits;
+            if(!readOscInt(data, size, pos, bits)) return false;
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            numbers.push_back(value);
+        } else if(tags[t] == 's'){
+            string value;
+            if(!readOscString(data, size, pos, value)) return false;
+            strings.push_back(value);
+        } else {
+            return false;
+        }
+    }
+
+    if(address == "/cue/preset" && numbers.size() == 1){
+        command.type = CueCommand::GOTO_PRESET;
+        command.index = numbers[0];
+    } else if(address == "/cue/scene" && numbers.size() == 1){
+        command.type = CueCommand::GOTO_SCENE;
+        command.index = numbers[0];
+    } else if(address == "/cue/pause"){
+        command.type = CueCommand::PAUSE;
+    } else if(address == "/cue/resume"){
+        command.type = CueCommand::RESUME;
+    } else if(address == "/cue/param" && strings.size() == 2 && numbers.size() == 1){
+        command.type = CueCommand::SET_PARAMETER;
+        strncpy(command.source, strings[0].c_str(), sizeof(command.source) - 1);
+        strncpy(command.parameter, strings[1].c_str(), sizeof(command.parameter) - 1);
+        command.value = numbers[0];
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool CueControlServer::parseText(string text, CueCommand & command){
+    text = ofTrim(text);
+    size_t space = text.find(' ');
+    string verb = text.substr(0, space);
+    string rest = space == string::npos ? "" : ofTrim(text.substr(space + 1));
+
+    if(verb == "preset" && !rest.empty()){
+        command.type = CueCommand::GOTO_PRESET;
+        command.index = ofToInt(rest);
+    } else if(verb == "scene" && !rest.empty()){
+        command.type = CueCommand::GOTO_SCENE;
+        command.index = ofToInt(rest);
+    } else if(verb == "pause"){
+        command.type = CueCommand::PAUSE;
+    } else if(verb == "resume"){
+        command.type = CueCommand::RESUME;
+    } else if(verb == "param"){
+        // source names have spaces: "param <source>:<parameter> <value>"
+        size_t colon = rest.rfind(':');
+        size_t valueStart = rest.rfind(' ');
+        if(colon == string::npos || valueStart == string::npos || valueStart < colon) return false;
+        command.type = CueCommand::SET_PARAMETER;
+        strncpy(command.source, rest.substr(0, colon).c_str(), sizeof(command.source) - 1);
+        strncpy(command.parameter, rest.substr(colon + 1, valueStart - colon - 1).c_str(), sizeof(command.parameter) - 1);
+        command.value = ofToFloat(rest.substr(valueStart + 1));
+    } else {
+        return false;
+    }
+    return true;
+}
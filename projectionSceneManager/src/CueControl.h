@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxNetwork.h"
+#include "SpscQueue.h"
+
+// One remote cue, filled in on the network thread and applied by
+// SceneManager::update()
+struct CueCommand {
+    enum Type {
+        GOTO_PRESET,
+        GOTO_SCENE,
+        PAUSE,
+        RESUME,
+        SET_PARAMETER
+    };
+
+    Type type;
+    int index;
+    char source[48];
+    char parameter[32];
+    float value;
+    uint64_t received; // ofGetElapsedTimeMicros() when the packet arrived
+};
+
+typedef SpscQueue<CueCommand> CueQueue;
+
+// UDP endpoint for cues from a lighting desk or show controller. It runs on
+// its own thread, blocks only in receive and hands every command to the
+// scene manager through a lock-free queue, so a cue is applied at the start
+// of the next frame.
+//
+// Accepts OSC messages
+//   /cue/preset i   /cue/scene i   /cue/pause   /cue/resume
+//   /cue/param s s f   (source name, parameter, value)
+// and the same as plain text, e.g. "preset 2" or "param Bouncing Balls FBO Source:count 200"
+//
+// Senders are not checked, so the app only listens when a port is given
+// with --cue-port.
+class CueControlServer : public ofThread {
+    public:
+        CueControlServer();
+        ~CueControlServer();
+
+        bool setup(int port, CueQueue * _queue);
+        void exit();
+
+        int getNumReceived();
+        int getNumRejected();
+        int getNumDropped();
+
+        static bool parse(const char * data, int size, CueCommand & command);
+        static bool parseOsc(const char * data, int size, CueCommand & command);
+        static bool parseText(string text, CueCommand & command);
+
+    private:
+        void threadedFunction();
+
+        ofxUDPManager socket;
+        CueQueue * queue;
+        bool listening;
+
+        std::atomic<int> received;
+        std::atomic<int> rejected;
+        std::atomic<int> dropped;
+};
@@ -0,0 +1,133 @@
+#include "DrawStats.h"
+#include <iomanip>
+
+DrawStats * DrawStats::_instance = 0;
+bool DrawStats::enabled = false;
+
+DrawStats * DrawStats::instance(){
+    if(_instance == 0){
+        _instance = new DrawStats();
+    }
+    return _instance;
+}
+
+DrawStats::DrawStats(){
+    reportInterval = 2;
+    reset();
+}
+
+void DrawStats::setEnabled(bool _enabled){
+    if(_enabled && !enabled) reset();
+    enabled = _enabled;
+}
+
+void DrawStats::reset(){
+    sources.clear();
+    currentName = "ofApp";
+    current = &sources[currentName];
+    styleDepth = matrixDepth = 0;
+    scopeStyleDepth = scopeMatrixDepth = 0;
+    frames = 0;
+    frameSeconds = 0;
+    lastReport = ofGetElapsedTimef();
+}
+
+// Scopes don't nest, sources are drawn one after another into their FBOs
+void DrawStats::beginSource(const string & name){
+    currentName = name;
+    current = &sources[name];
+    current->frames++;
+    scopeStyleDepth = styleDepth;
+    scopeMatrixDepth = matrixDepth;
+}
+
+void DrawStats::endSource(){
+    if(styleDepth != scopeStyleDepth) current->imbalances++;
+    if(matrixDepth != scopeMatrixDepth) current->imbalances++;
+    // the next source starts from a clean count
+    styleDepth = scopeStyleDepth;
+    matrixDepth = scopeMatrixDepth;
+    currentName = "ofApp";
+    current = &sources[currentName];
+}
+
+void DrawStats::frame(){
+    if(!enabled) return;
+    frames++;
+    sources["ofApp"].frames++;
+    frameSeconds += ofGetLastFrameTime();
+    if(ofGetElapsedTimef() - lastReport < reportInterval) return;
+    ofLogNotice("DrawStats") << getReport();
+    reset();
+}
+
+//--------------------------------------------------------------
+// Pixel estimates
+
+// The upper left of the modelview maps object space onto the FBO, whose
+// projection is one unit per pixel at z = 0. Rotations out of the plane
+// shrink the determinant like they shrink the projected area.
+double DrawStats::pixelScale(){
+    ofMatrix4x4 m = ofGetCurrentMatrix(OF_MATRIX_MODELVIEW);
+    return fabs(m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0));
+}
+
+void DrawStats::countRectangle(float w, float h){
+    current->pixels += fabs(w * h) * pixelScale();
+}
+
+// line widths are in pixels whatever the matrix
+void DrawStats::countLine(float x1, float y1, float x2, float y2){
+    current->pixels += ofDist(x1, y1, x2, y2) * sqrt(pixelScale()) * ofGetStyle().lineWidth;
+}
+
+static double triangleArea(const ofVec3f & a, const ofVec3f & b, const ofVec3f & c){
+    return fabs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+}
+
+void DrawStats::countMesh(ofMesh & mesh){
+    const vector<ofVec3f> & vertices = mesh.getVertices();
+    const vector<ofIndexType> & indices = mesh.getIndices();
+    bool indexed = !indices.empty();
+    int n = indexed ? indices.size() : vertices.size();
+    auto at = [&](int i) -> const ofVec3f & { return vertices[indexed ? indices[i] : i]; };
+
+    double area = 0, length = 0;
+    ofPrimitiveMode mode = mesh.getMode();
+    if(mode == OF_PRIMITIVE_TRIANGLES){
+        for(int i = 0; i + 2 < n; i += 3) area += triangleArea(at(i), at(i + 1), at(i + 2));
+    } else if(mode == OF_PRIMITIVE_TRIANGLE_STRIP){
+        for(int i = 0; i + 2 < n; i++) area += triangleArea(at(i), at(i + 1), at(i + 2));
+    } else if(mode == OF_PRIMITIVE_TRIANGLE_FAN){
+        for(int i = 1; i + 1 < n; i++) area += triangleArea(at(0), at(i), at(i + 1));
+    } else if(mode == OF_PRIMITIVE_LINES){
+        for(int i = 0; i + 1 < n; i += 2) length += at(i).distance(at(i + 1));
+    } else if(mode == OF_PRIMITIVE_LINE_STRIP || mode == OF_PRIMITIVE_LINE_LOOP){
+        for(int i = 0; i + 1 < n; i++) length += at(i).distance(at(i + 1));
+        if(mode == OF_PRIMITIVE_LINE_LOOP && n > 2) length += at(n - 1).distance(at(0));
+    } else {
+        current->pixels += n; // points
+        return;
+    }
+    double scale = pixelScale();
+    current->pixels += area * scale + length * sqrt(scale) * ofGetStyle().lineWidth;
+}
+
+//--------------------------------------------------------------
+// Averages per frame the source was drawn in
+string DrawStats::getReport(){
+    stringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << frames << " frames, " << (frames > 0 ? frameSeconds * 1000 / frames : 0) << "ms per frame" << endl;
+    for(map<string, Counters>::iterator it = sources.begin(); it != sources.end(); it++){
+        Counters & c = it->second;
+        if(c.frames == 0) continue;
+        float n = c.frames;
+        out << it->first << ": " << c.drawCalls / n << " draws, " << c.vertices / n << " vertices, "
+            << c.styleOps / n << " style, " << c.matrixOps / n << " matrix, " << c.colorChanges / n << " color, "
+            << c.blendChanges / n << " blend, " << c.pixels / n / 1000 << "k pixels";
+        if(c.imbalances > 0) out << ", " << c.imbalances << " unbalanced push/pop";
+        out << endl;
+    }
+    return out.str();
+}
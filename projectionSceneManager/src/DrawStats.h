@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ofMain.h"
+
+// Draw call and state change accounting, per FBO source and frame.
+//
+// The sources and renderers draw through the counted:: functions below,
+// which call the openFrameworks function of the same name and, while the
+// statistics are enabled, count it for the source whose draw() is running
+// (a DrawStatsScope at its top). Style and matrix pushes and pops that do
+// not match within a source's draw() are counted as imbalances.
+//
+// Every draw also adds an estimate of the pixels it shades: the area of
+// the primitive in object space times the scale of the modelview matrix,
+// lines as their length times the line width. Clears are not counted,
+// they are free on the tile based GPU of the Pi. Overlap is counted as
+// often as it is drawn, which is the point: it shows the overdraw.
+//
+// Every couple of seconds the per frame averages are logged along with
+// the frame time. Disabled, a counted call costs one branch.
+class DrawStats {
+    public:
+        struct Counters {
+            uint64_t frames;
+            uint64_t drawCalls;
+            uint64_t vertices;
+            uint64_t styleOps;
+            uint64_t matrixOps;
+            uint64_t colorChanges;
+            uint64_t blendChanges;
+            uint64_t imbalances;
+            double pixels;
+        };
+
+        static DrawStats * instance();
+
+        static bool isEnabled(){
+            return enabled;
+        }
+        void setEnabled(bool _enabled);
+
+        // the source a DrawStatsScope is open for
+        void beginSource(const string & name);
+        void endSource();
+
+        // end of ofApp::draw()
+        void frame();
+        string getReport();
+
+        void countDraw(int vertices){ current->drawCalls++; current->vertices += vertices; }
+        void countStyle(int depthChange){ current->styleOps++; styleDepth += depthChange; }
+        void countMatrix(int depthChange){ current->matrixOps++; matrixDepth += depthChange; }
+        void countColor(){ current->colorChanges++; }
+        void countBlend(){ current->blendChanges++; }
+
+        // pixels shaded, see above
+        void countRectangle(float w, float h);
+        void countLine(float x1, float y1, float x2, float y2);
+        void countMesh(ofMesh & mesh);
+
+        float reportInterval; // seconds
+
+    private:
+        DrawStats();
+        void reset();
+
+        // area scale of the current modelview matrix
+        static double pixelScale();
+
+        static DrawStats * _instance;
+        static bool enabled;
+
+        // drawing outside of any source (atlas, batcher) is booked on "ofApp"
+        map<string, Counters> sources;
+        Counters * current;
+        string currentName;
+        int styleDepth, matrixDepth;
+        int scopeStyleDepth, scopeMatrixDepth;
+
+        uint64_t frames;
+        double frameSeconds;
+        float lastReport;
+};
+
+class DrawStatsScope {
+    public:
+        DrawStatsScope(const string & name){
+            if(DrawStats::isEnabled()) DrawStats::instance()->beginSource(name);
+        }
+        ~DrawStatsScope(){
+            if(DrawStats::isEnabled()) DrawStats::instance()->endSource();
+        }
+};
+
+namespace counted {
+    inline DrawStats * stats(){
+        return DrawStats::isEnabled() ? DrawStats::instance() : NULL;
+    }
+
+    inline void ofPushStyle(){ ::ofPushStyle(); if(DrawStats * s = stats()) s->countStyle(1); }
+    inline void ofPopStyle(){ ::ofPopStyle(); if(DrawStats * s = stats()) s->countStyle(-1); }
+    inline void ofFill(){ ::ofFill(); if(DrawStats * s = stats()) s->countStyle(0); }
+    inline void ofNoFill(){ ::ofNoFill(); if(DrawStats * s = stats()) s->countStyle(0); }
+    inline void ofSetLineWidth(float width){ ::ofSetLineWidth(width); if(DrawStats * s = stats()) s->countStyle(0); }
+
+    inline void ofSetColor(const ofColor & color){ ::ofSetColor(color); if(DrawStats * s = stats()) s->countColor(); }
+    inline void ofSetColor(const ofColor & color, int alpha){ ::ofSetColor(color, alpha); if(DrawStats * s = stats()) s->countColor(); }
+    inline void ofSetColor(int gray){ ::ofSetColor(gray); if(DrawStats * s = stats()) s->countColor(); }
+
+    inline void ofEnableAlphaBlending(){ ::ofEnableAlphaBlending(); if(DrawStats * s = stats()) s->countBlend(); }
+    inline void ofDisableAlphaBlending(){ ::ofDisableAlphaBlending(); if(DrawStats * s = stats()) s->countBlend(); }
+
+    inline void ofPushMatrix(){ ::ofPushMatrix(); if(DrawStats * s = stats()) s->countMatrix(1); }
+    inline void ofPopMatrix(){ ::ofPopMatrix(); if(DrawStats * s = stats()) s->countMatrix(-1); }
+    inline void ofPushView(){ ::ofPushView(); if(DrawStats * s = stats()) s->countMatrix(1); }
+    inline void ofPopView(){ ::ofPopView(); if(DrawStats * s = stats()) s->countMatrix(-1); }
+    inline void ofTranslate(float x, float y){ ::ofTranslate(x, y); if(DrawStats * s = stats()) s->countMatrix(0); }
+    inline void ofScale(float x, float y){ ::ofScale(x, y); if(DrawStats * s = stats()) s->countMatrix(0); }
+    inline void ofRotate(float degrees){ ::ofRotate(degrees); if(DrawStats * s = stats()) s->countMatrix(0); }
+    inline void ofRotateX(float degrees){ ::ofRotateX(degrees); if(DrawStats * s = stats()) s->countMatrix(0); }
+    inline void ofRotateY(float degrees){ ::ofRotateY(degrees); if(DrawStats * s = stats()) s->countMatrix(0); }
+
+    inline void ofDrawRectangle(float x, float y, float w, float h){
+        ::ofDrawRectangle(x, y, w, h);
+        if(DrawStats * s = stats()){
+            s->countDraw(4);
+            s->countRectangle(w, h);
+        }
+    }
+    inline void ofDrawLine(float x1, float y1, float x2, float y2){
+        ::ofDrawLine(x1, y1, x2, y2);
+        if(DrawStats * s = stats()){
+            s->countDraw(2);
+            s->countLine(x1, y1, x2, y2);
+        }
+    }
+    // a background quad and six vertices per glyph
+    inline void ofDrawBitmapStringHighlight(const string & text, float x, float y, const ofColor & background, const ofColor & foreground){
+        ::ofDrawBitmapStringHighlight(text, x, y, background, foreground);
+        if(DrawStats * s = stats()){
+            s->countDraw(4);
+            s->countDraw(text.size() * 6);
+            s->countRectangle(text.size() * 8 + 8, 19);
+        }
+    }
+
+    // indexed meshes submit their indices
+    inline void draw(ofMesh & mesh){
+        mesh.draw();
+        if(DrawStats * s = stats()){
+            s->countDraw(mesh.getNumIndices() > 0 ? mesh.getNumIndices() : mesh.getNumVertices());
+            s->countMesh(mesh);
+        }
+    }
+    // textures and video players, one quad
+    template<typename Drawable>
+    void draw(Drawable & drawable, float x, float y, float w, float h){
+        drawable.draw(x, y, w, h);
+        if(DrawStats * s = stats()){
+            s->countDraw(4);
+            s->countRectangle(w, h);
+        }
+    }
+}
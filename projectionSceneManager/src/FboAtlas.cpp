@@ -0,0 +1,124 @@
+#include "FboAtlas.h"
+
+FboAtlas::FboAtlas(){
+    allocated = false;
+    enabled = false;
+    padding = 2;
+}
+
+void FboAtlas::add(ofx::piMapper::FboSource * source){
+    if(allocated){
+        ofLogError("FboAtlas") << "add() called after allocate(), " << source->getName() << " ignored";
+        return;
+    }
+    Entry e;
+    e.source = source;
+    entries.push_back(e);
+}
+
+void FboAtlas::allocate(int maxWidth){
+    for(unsigned int i = 0; i < entries.size(); i++){
+        ofTexture * tex = entries[i].source->getTexture();
+        entries[i].rect = ofRectangle(0, 0, tex->getWidth(), tex->getHeight());
+    }
+    // simple shelf packing, tallest sources first
+    sort(entries.begin(), entries.end(), [](const Entry & a, const Entry & b){
+        return a.rect.height > b.rect.height;
+    });
+
+    int x = 0, y = 0, shelfHeight = 0, usedWidth = 0;
+    for(unsigned int i = 0; i < entries.size(); i++){
+        ofRectangle & r = entries[i].rect;
+        if(x > 0 && x + r.width > maxWidth){
+            x = 0;
+            y += shelfHeight + padding;
+            shelfHeight = 0;
+        }
+        r.x = x;
+        r.y = y;
+        x += r.width + padding;
+        shelfHeight = MAX(shelfHeight, (int)r.height);
+        usedWidth = MAX(usedWidth, (int)(r.x + r.width));
+    }
+    int width = MAX(1, usedWidth);
+    int height = MAX(1, y + shelfHeight);
+
+    // normalized texture coordinates make remapping surfaces a simple scale and offset
+    bool arb = ofGetUsingArbTex();
+    ofDisableArbTex();
+    fbo.allocate(width, height, GL_RGBA);
+    if(arb) ofEnableArbTex();
+
+    fbo.begin();
+    ofClear(0, 0, 0, 0);
+    fbo.end();
+
+    allocated = true;
+    ofLogNotice("FboAtlas") << "packed " << entries.size() << " sources into " << width << "x" << height;
+}
+
+void FboAtlas::setEnabled(bool e){
+    enabled = e && allocated;
+    for(unsigned int i = 0; i < entries.size(); i++){
+        entries[i].source->setDisableDraw(enabled);
+    }
+}
+
+bool FboAtlas::isEnabled(){
+    return enabled;
+}
+
+void FboAtlas::render(){
+    if(!enabled) return;
+
+    fbo.begin();
+    glEnable(GL_SCISSOR_TEST);
+    for(unsigned int i = 0; i < entries.size(); i++){
+        ofRectangle & r = entries[i].rect;
+        counted::ofPushView();
+        // the scissor keeps the sources' own ofClear() inside their region
+        glViewport(r.x, r.y, r.width, r.height);
+        glScissor(r.x, r.y, r.width, r.height);
+        ofSetupScreenOrtho(r.width, r.height);
+        counted::ofPushStyle();
+        entries[i].source->draw();
+        counted::ofPopStyle();
+        counted::ofPopView();
+    }
+    glDisable(GL_SCISSOR_TEST);
+    fbo.end();
+}
+
+bool FboAtlas::contains(string sourceName){
+    for(unsigned int i = 0; i < entries.size(); i++){
+        if(entries[i].source->getName() == sourceName) return true;
+    }
+    return false;
+}
+
+ofRectangle FboAtlas::getTexRegion(string sourceName){
+    for(unsigned int i = 0; i < entries.size(); i++){
+        if(entries[i].source->getName() == sourceName){
+            ofRectangle & r = entries[i].rect;
+            return ofRectangle(r.x / fbo.getWidth(), r.y / fbo.getHeight(),
+                               r.width / fbo.getWidth(), r.height / fbo.getHeight());
+        }
+    }
+    return ofRectangle(0, 0, 1, 1);
+}
+
+ofRectangle FboAtlas::getTexClamp(string sourceName){
+    ofRectangle region = getTexRegion(sourceName);
+    float halfX = 0.5f / fbo.getWidth();
+    float halfY = 0.5f / fbo.getHeight();
+    return ofRectangle(region.x + halfX, region.y + halfY,
+                       MAX(0.0f, region.width - 2 * halfX), MAX(0.0f, region.height - 2 * halfY));
+}
+
+ofTexture & FboAtlas::getTexture(){
+    return fbo.getTexture();
+}
+
+int FboAtlas::getNumSources(){
+    return entries.size();
+}
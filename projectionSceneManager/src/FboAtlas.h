@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FboSource.h"
+#include "DrawStats.h"
+
+// Renders several FBO sources into sub-rectangles of one shared FBO so that
+// all surfaces using them can be drawn with a single texture bind.
+// Sources keep drawing in their own coordinate system, the atlas sets up a
+// viewport and a scissor rectangle for each of them.
+class FboAtlas {
+    public:
+        FboAtlas();
+
+        // Sources have to be added before allocate() is called
+        void add(ofx::piMapper::FboSource * source);
+        void allocate(int maxWidth = 2048);
+
+        // When enabled the sources stop rendering into their own FBOs
+        void setEnabled(bool e);
+        bool isEnabled();
+
+        void render();
+
+        bool contains(string sourceName);
+        // Region of a source in texture coordinates of getTexture()
+        ofRectangle getTexRegion(string sourceName);
+        // The region inset by half a texel, texture coordinates clamped to it
+        // are filtered from the source's own pixels only
+        ofRectangle getTexClamp(string sourceName);
+        ofTexture & getTexture();
+
+        int getNumSources();
+
+    private:
+        struct Entry {
+            ofx::piMapper::FboSource * source;
+            ofRectangle rect; // pixels, top-left origin
+        };
+
+        vector<Entry> entries;
+        ofFbo fbo;
+        bool allocated;
+        bool enabled;
+        int padding;
+};
@@ -0,0 +1,208 @@
+#include "ForceField.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+
+ForceField::ForceField(){
+    width = height = 0;
+    cellSize = 1;
+    cols = rows = 1;
+    maxRadius = 0;
+    built = false;
+}
+
+// cellSize works best around the usual query radius
+void ForceField::setup(float _width, float _height, float _cellSize){
+    width = _width;
+    height = _height;
+    cellSize = _cellSize > 1 ? _cellSize : 1;
+    cols = (int)ceilf(width / cellSize);
+    rows = (int)ceilf(height / cellSize);
+    if(cols < 1) cols = 1;
+    if(rows < 1) rows = 1;
+    built = false;
+}
+
+void ForceField::clear(){
+    attractors.clear();
+    built = false;
+}
+
+int ForceField::add(float x, float y, float radius, float strength){
+    Attractor a;
+    a.x = x;
+    a.y = y;
+    a.radius = radius;
+    a.strength = strength;
+    attractors.push_back(a);
+    built = false;
+    return attractors.size() - 1;
+}
+
+void ForceField::set(int index, float x, float y){
+    attractors[index].x = x;
+    attractors[index].y = y;
+    built = false;
+}
+
+int ForceField::size(){
+    return attractors.size();
+}
+
+ForceField::Attractor & ForceField::get(int index){
+    return attractors[index];
+}
+
+// Counting sort by cell: two passes over the attractors, no allocation
+// once the vectors have grown
+void ForceField::build(){
+    int numCells = cols * rows;
+    cellStart.assign(numCells + 1, 0);
+    order.resize(attractors.size());
+    maxRadius = 0;
+
+    for(unsigned int i = 0; i < attractors.size(); i++){
+        cellStart[cellIndex(attractors[i].x, attractors[i].y) + 1]++;
+        if(attractors[i].radius > maxRadius) maxRadius = attractors[i].radius;
+    }
+    for(int c = 0; c < numCells; c++) cellStart[c + 1] += cellStart[c];
+
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for(unsigned int i = 0; i < attractors.size(); i++){
+        order[fill[cellIndex(attractors[i].x, attractors[i].y)]++] = i;
+    }
+    built = true;
+}
+
+// Points outside the area go into the border cells
+int ForceField::cellIndex(float x, float y){
+    int cx = (int)(x / cellSize);
+    int cy = (int)(y / cellSize);
+    cx = cx < 0 ? 0 : (cx >= cols ? cols - 1 : cx);
+    cy = cy < 0 ? 0 : (cy >= rows ? rows - 1 : cy);
+    return cy * cols + cx;
+}
+
+static inline int clampCell(float v, float invCellSize, int count){
+    int c = (int)(v * invCellSize);
+    return c < 0 ? 0 : (c >= count ? count - 1 : c);
+}
+
+void ForceField::cellRange(float x, float y, float r, int & x0, int & y0, int & x1, int & y1){
+    if(!built) build();
+    float inv = 1.0f / cellSize;
+    x0 = clampCell(x - r, inv, cols);
+    x1 = clampCell(x + r, inv, cols);
+    y0 = clampCell(y - r, inv, rows);
+    y1 = clampCell(y + r, inv, rows);
+}
+
+int ForceField::nearest(float x, float y, float radius, float & dist){
+    int best = -1;
+    float bestDist = radius;
+    forEachNear(x, y, radius, [&](Attractor & a, float, float, float d){
+        if(d < bestDist){
+            bestDist = d;
+            best = &a - &attractors[0];
+        }
+    });
+    dist = bestDist;
+    return best;
+}
+
+int ForceField::queryRadius(float x, float y, float radius, std::vector<int> & out){
+    out.clear();
+    forEachNear(x, y, radius, [&](Attractor & a, float, float, float){
+        out.push_back(&a - &attractors[0]);
+    });
+    return out.size();
+}
+
+//--------------------------------------------------------------
+// Islands keep the density of the current game (one per 400x480 of
+// screen), atoms are spread over the same area. Both variants compute the
+// wander force sum and the capture test, the checksums have to match.
+void ForceField::benchmark(){
+    using namespace std::chrono;
+    const int attractorCounts[] = { 1, 16, 128, 1024 };
+    const int atomCounts[] = { 100, 1000, 10000 };
+    const float wanderRadius = 150;
+    const float captureRadius = 100;
+
+    std::cout << "ForceField benchmark, microseconds per update" << std::endl;
+    std::cout << std::setw(8) << "islands" << std::setw(8) << "atoms"
+              << std::setw(12) << "brute" << std::setw(12) << "grid"
+              << std::setw(10) << "speedup" << "  check" << std::endl;
+
+    for(int n : attractorCounts){
+        for(int m : atomCounts){
+            std::mt19937 rng(n * 7919 + m);
+            float side = sqrtf((float)n);
+            float w = 400 * side;
+            float h = 480 * side;
+            std::uniform_real_distribution<float> rx(0, w), ry(0, h);
+
+            ForceField field;
+            field.setup(w, h, wanderRadius);
+            for(int i = 0; i < n; i++) field.add(rx(rng), ry(rng), wanderRadius, -0.8f);
+            std::vector<float> ax(m), ay(m);
+            for(int i = 0; i < m; i++){
+                ax[i] = rx(rng);
+                ay[i] = ry(rng);
+            }
+
+            int repeats = 20;
+            double bruteSum = 0, gridSum = 0;
+            int bruteCaught = 0, gridCaught = 0;
+
+            steady_clock::time_point start = steady_clock::now();
+            for(int r = 0; r < repeats; r++){
+                for(int i = 0; i < m; i++){
+                    float fx = 0, fy = 0;
+                    float best = captureRadius;
+                    for(int j = 0; j < n; j++){
+                        Attractor & a = field.attractors[j];
+                        float dx = a.x - ax[i];
+                        float dy = a.y - ay[i];
+                        float d = sqrtf(dx * dx + dy * dy);
+                        if(d < a.radius && d > 0){
+                            fx += dx / d * a.strength;
+                            fy += dy / d * a.strength;
+                        }
+                        if(d < best) best = d;
+                    }
+                    bruteSum += fx + fy;
+                    if(best < captureRadius) bruteCaught++;
+                }
+            }
+            double bruteTime = duration_cast<microseconds>(steady_clock::now() - start).count() / (double)repeats;
+
+            start = steady_clock::now();
+            for(int r = 0; r < repeats; r++){
+                // the islands move every frame, so the grid is rebuilt as well
+                field.build();
+                for(int i = 0; i < m; i++){
+                    float fx = 0, fy = 0;
+                    field.forEachNear(ax[i], ay[i], wanderRadius, [&](Attractor & a, float dx, float dy, float d){
+                        if(d > 0){
+                            fx += dx / d * a.strength;
+                            fy += dy / d * a.strength;
+                        }
+                    });
+                    gridSum += fx + fy;
+                    float dist;
+                    if(field.nearest(ax[i], ay[i], captureRadius, dist) >= 0) gridCaught++;
+                }
+            }
+            double gridTime = duration_cast<microseconds>(steady_clock::now() - start).count() / (double)repeats;
+
+            bool match = bruteCaught == gridCaught && fabs(bruteSum - gridSum) < 1e-3 * (1 + fabs(bruteSum));
+            std::cout << std::setw(8) << n << std::setw(8) << m
+                      << std::setw(12) << std::fixed << std::setprecision(1) << bruteTime
+                      << std::setw(12) << gridTime
+                      << std::setw(9) << std::setprecision(2) << (gridTime > 0 ? bruteTime / gridTime : 0) << "x"
+                      << "  " << (match ? "ok" : "MISMATCH") << std::endl;
+        }
+    }
+}
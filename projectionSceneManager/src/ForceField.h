@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+
+// A set of point attractors (negative strength repels) bucketed into a
+// uniform grid, so that asking which attractors reach a point only visits
+// the cells around it instead of every attractor. Atoms use it for their
+// forces and for the capture test, with any number of islands or buttons.
+//
+// Plain floats and no openFrameworks calls, so it can be benchmarked
+// headless (see benchmark() and the --bench-forcefield flag).
+class ForceField {
+    public:
+        struct Attractor {
+            float x, y;
+            float radius;   // no effect beyond this distance
+            float strength; // < 0 pushes away
+        };
+
+        ForceField();
+
+        void setup(float width, float height, float cellSize);
+        void clear();
+        int add(float x, float y, float radius, float strength);
+        void set(int index, float x, float y);
+        // Call after adding or moving attractors, before querying
+        void build();
+
+        int size();
+        Attractor & get(int index);
+
+        // Calls f(attractor, dx, dy, dist) for every attractor within both
+        // its own radius and maxRadius of (x, y), dx/dy pointing towards it
+        template<typename F>
+        void forEachNear(float x, float y, float maxRadius, F f);
+
+        // Closest attractor within maxRadius or -1, its distance in dist
+        int nearest(float x, float y, float maxRadius, float & dist);
+        int queryRadius(float x, float y, float radius, std::vector<int> & out);
+
+        // Brute force and grid timings for growing attractor and atom counts
+        static void benchmark();
+
+    private:
+        static const unsigned int linearLimit = 16;
+
+        int cellIndex(float x, float y);
+        void cellRange(float x, float y, float r, int & x0, int & y0, int & x1, int & y1);
+
+        std::vector<Attractor> attractors;
+        float width, height, cellSize;
+        int cols, rows;
+        float maxRadius;
+
+        // attractors sorted by cell, cellStart[c] .. cellStart[c + 1] indexes order
+        std::vector<int> cellStart;
+        std::vector<int> order;
+        bool built;
+};
+
+template<typename F>
+void ForceField::forEachNear(float x, float y, float radius, F f){
+    // a handful of attractors is cheaper to scan than to look up
+    if(attractors.size() <= linearLimit){
+        for(unsigned int i = 0; i < attractors.size(); i++){
+            Attractor & a = attractors[i];
+            float dx = a.x - x;
+            float dy = a.y - y;
+            float d2 = dx * dx + dy * dy;
+            float r = a.radius < radius ? a.radius : radius;
+            if(d2 < r * r) f(a, dx, dy, sqrtf(d2));
+        }
+        return;
+    }
+
+    int x0, y0, x1, y1;
+    cellRange(x, y, radius < maxRadius ? radius : maxRadius, x0, y0, x1, y1);
+    for(int cy = y0; cy <= y1; cy++){
+        for(int cx = x0; cx <= x1; cx++){
+            int c = cy * cols + cx;
+            for(int i = cellStart[c]; i < cellStart[c + 1]; i++){
+                Attractor & a = attractors[order[i]];
+                float dx = a.x - x;
+                float dy = a.y - y;
+                float d2 = dx * dx + dy * dy;
+                float r = a.radius < radius ? a.radius : radius;
+                if(d2 < r * r) f(a, dx, dy, sqrtf(d2));
+            }
+        }
+    }
+}
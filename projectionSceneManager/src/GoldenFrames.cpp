@@ -0,0 +1,131 @@
+#include "GoldenFrames.h"
+
+GoldenFrames::GoldenFrames(){
+    tolerance = 5;
+    maxDifferingShare = 0.001;
+    record = false;
+    running = false;
+    startMillis = 0;
+    frameCount = 0;
+    compared = failed = missing = 0;
+}
+
+void GoldenFrames::setup(const vector<ofx::piMapper::FboSource *> & _sources, string _directory, bool _record,
+                         vector<int> _captureFrames, uint64_t _startMillis){
+    sources = _sources;
+    directory = _directory;
+    record = _record;
+    captureFrames = _captureFrames;
+    sort(captureFrames.begin(), captureFrames.end());
+    startMillis = _startMillis;
+    frameCount = 0;
+    compared = failed = missing = 0;
+    report = "";
+
+    targets.resize(sources.size());
+    for(unsigned int i = 0; i < sources.size(); i++){
+        ofTexture * texture = sources[i]->getTexture();
+        targets[i].allocate(texture->getWidth(), texture->getHeight(), GL_RGBA);
+    }
+    ofDirectory::createDirectory(ofFilePath::join(directory, "diffs"), false, true);
+    running = !sources.empty() && !captureFrames.empty();
+    ofLogNotice("GoldenFrames") << (record ? "recording " : "checking ") << sources.size()
+                                << " sources in " << directory;
+}
+
+bool GoldenFrames::isRunning(){
+    return running;
+}
+
+uint64_t GoldenFrames::now(){
+    return startMillis + frameCount * 1000 / 60;
+}
+
+void GoldenFrames::step(){
+    if(!running) return;
+    for(unsigned int i = 0; i < sources.size(); i++){
+        sources[i]->update();
+        targets[i].begin();
+        ofClear(0, 0, 0, 0);
+        ofPushStyle();
+        sources[i]->draw();
+        ofPopStyle();
+        targets[i].end();
+    }
+    frameCount++;
+
+    if(std::find(captureFrames.begin(), captureFrames.end(), frameCount) != captureFrames.end()) capture();
+    if(frameCount >= captureFrames.back()) finish();
+}
+
+string GoldenFrames::fileName(int source){
+    string name = ofToLower(sources[source]->getName());
+    for(unsigned int c = 0; c < name.size(); c++){
+        if(!isalnum(name[c])) name[c] = '-';
+    }
+    char frame[16];
+    sprintf(frame, "-%04d.png", frameCount);
+    return name + frame;
+}
+
+void GoldenFrames::capture(){
+    for(unsigned int i = 0; i < sources.size(); i++){
+        ofPixels actual;
+        targets[i].readToPixels(actual);
+        actual.setImageType(OF_IMAGE_COLOR_ALPHA);
+        string path = ofFilePath::join(directory, fileName(i));
+
+        if(record){
+            ofSaveImage(actual, path);
+            continue;
+        }
+
+        ofPixels expected;
+        if(!ofFile::doesFileExist(path, false) || !ofLoadImage(expected, path)){
+            ofLogError("GoldenFrames") << "no golden image " << path;
+            report += "{\"image\":\"" + fileName(i) + "\",\"error\":\"missing\"},";
+            missing++;
+            continue;
+        }
+        expected.setImageType(OF_IMAGE_COLOR_ALPHA);
+        compared++;
+        if(expected.getWidth() != actual.getWidth() || expected.getHeight() != actual.getHeight()){
+            ofLogError("GoldenFrames") << fileName(i) << ": size changed";
+            report += "{\"image\":\"" + fileName(i) + "\",\"error\":\"size changed\"},";
+            failed++;
+            continue;
+        }
+
+        ofPixels diff;
+        diff.allocate(actual.getWidth(), actual.getHeight(), OF_PIXELS_RGBA);
+        ImageDiff::Result result = ImageDiff::compare(expected.getData(), actual.getData(),
+                                                      actual.getWidth(), actual.getHeight(), tolerance, diff.getData());
+        bool passed = result.differingShare <= maxDifferingShare;
+        report += "{\"image\":\"" + fileName(i) + "\",\"passed\":" + (passed ? "true" : "false")
+                + ",\"differing\":" + ofToString(result.differing) + ",\"maxDelta\":" + ofToString(result.maxDelta)
+                + ",\"meanDelta\":" + ofToString(result.meanDelta) + "},";
+        if(passed) continue;
+        failed++;
+        ofSaveImage(diff, ofFilePath::join(ofFilePath::join(directory, "diffs"), fileName(i)));
+        ofLogError("GoldenFrames") << fileName(i) << ": " << result.differing << " pixels differ, max deltaE "
+                                   << result.maxDelta;
+    }
+}
+
+void GoldenFrames::finish(){
+    running = false;
+    if(record){
+        ofLogNotice("GoldenFrames") << "recorded " << sources.size() * captureFrames.size() << " images to " << directory;
+        ofExit(0);
+        return;
+    }
+    if(!report.empty()) report.erase(report.size() - 1);
+    ofstream file(ofFilePath::join(directory, "report.json").c_str());
+    file << "{\"tolerance\":" << tolerance << ",\"maxDifferingShare\":" << maxDifferingShare
+         << ",\"compared\":" << compared << ",\"failed\":" << failed << ",\"missing\":" << missing
+         << ",\"images\":[" << report << "]}" << endl;
+    ofLogNotice("GoldenFrames") << compared << " images compared, " << failed << " failed, " << missing << " missing";
+    // a wrong directory or one never recorded must not pass
+    if(compared == 0) ofLogError("GoldenFrames") << "no golden images in " << directory;
+    ofExit(failed > 0 || missing > 0 || compared == 0 ? 1 : 0);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FboSource.h"
+#include "ImageDiff.h"
+
+// Golden image checks for the FBO sources, the safety net for renderer
+// optimisations.
+//
+//   bin/projectionSceneManager --golden-record golden    once, on a look that was signed off
+//   bin/projectionSceneManager --golden-check golden     after every change, exit code 1 on a difference
+//
+// Random numbers are seeded and the clock advances a fixed 1/60 s per
+// frame. piMapper is left out: every source is updated and drawn into an
+// FBO of its own each frame, whatever the presets map, and read back on
+// the capture frames (--golden-frames, 30,120,300 by default). A check
+// compares with ImageDiff and writes an image of each difference to
+// <dir>/diffs, plus <dir>/report.json. A missing golden image fails the
+// check like a difference does, so does a check that compared nothing.
+// Only pass sources that draw the same on every run: the app leaves out
+// the video, which decodes at its own pace.
+class GoldenFrames {
+    public:
+        GoldenFrames();
+
+        static const int seed = 1234;
+
+        void setup(const vector<ofx::piMapper::FboSource *> & _sources, string _directory, bool _record,
+                   vector<int> _captureFrames, uint64_t _startMillis);
+        bool isRunning();
+
+        // the fixed clock, millis
+        uint64_t now();
+
+        // in place of piMapper.update()
+        void step();
+
+        float tolerance;        // deltaE, see ImageDiff
+        float maxDifferingShare;
+
+    private:
+        void capture();
+        void finish();
+        string fileName(int source);
+
+        vector<ofx::piMapper::FboSource *> sources;
+        vector<ofFbo> targets;
+        string directory;
+        bool record;
+        vector<int> captureFrames;
+        bool running;
+        uint64_t startMillis;
+        int frameCount;
+
+        int compared, failed, missing;
+        string report;
+};
@@ -0,0 +1,106 @@
+#include "ImageDiff.h"
+#include <cmath>
+
+// sRGB to linear, once for all 256 values
+static const float * linearTable(){
+    static float table[256];
+    static bool ready = false;
+    if(!ready){
+        for(int i = 0; i < 256; i++){
+            float c = i / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        ready = true;
+    }
+    return table;
+}
+
+static float labF(float t){
+    return t > 0.008856f ? cbrtf(t) : 7.787f * t + 16.0f / 116.0f;
+}
+
+void ImageDiff::toLab(const uint8_t * rgba, int width, int height, std::vector<float> & lab){
+    const float * linear = linearTable();
+    int count = width * height;
+
+    // over black, then a 3x3 box blur in sRGB
+    std::vector<float> rgb(count * 3);
+    for(int i = 0; i < count; i++){
+        float alpha = rgba[i * 4 + 3] / 255.0f;
+        for(int c = 0; c < 3; c++) rgb[i * 3 + c] = rgba[i * 4 + c] * alpha;
+    }
+    std::vector<float> blurred(count * 3);
+    for(int y = 0; y < height; y++){
+        for(int x = 0; x < width; x++){
+            float sum[3] = { 0, 0, 0 };
+            int n = 0;
+            for(int dy = -1; dy <= 1; dy++){
+                int yy = y + dy;
+                if(yy < 0 || yy >= height) continue;
+                for(int dx = -1; dx <= 1; dx++){
+                    int xx = x + dx;
+                    if(xx < 0 || xx >= width) continue;
+                    const float * p = &rgb[(yy * width + xx) * 3];
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                    n++;
+                }
+            }
+            float * out = &blurred[(y * width + x) * 3];
+            for(int c = 0; c < 3; c++) out[c] = sum[c] / n;
+        }
+    }
+
+    lab.resize(count * 3);
+    for(int i = 0; i < count; i++){
+        float r = linear[(int)(blurred[i * 3] + 0.5f)];
+        float g = linear[(int)(blurred[i * 3 + 1] + 0.5f)];
+        float b = linear[(int)(blurred[i * 3 + 2] + 0.5f)];
+        // D65 white
+        float fx = labF((0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f);
+        float fy = labF(0.2126f * r + 0.7152f * g + 0.0722f * b);
+        float fz = labF((0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f);
+        lab[i * 3] = 116 * fy - 16;
+        lab[i * 3 + 1] = 500 * (fx - fy);
+        lab[i * 3 + 2] = 200 * (fy - fz);
+    }
+}
+
+ImageDiff::Result ImageDiff::compare(const uint8_t * expected, const uint8_t * actual, int width, int height,
+                                     float tolerance, uint8_t * diff){
+    std::vector<float> a, b;
+    toLab(expected, width, height, a);
+    toLab(actual, width, height, b);
+
+    Result result = { 0, 0, 0, 0 };
+    int count = width * height;
+    double sum = 0;
+    for(int i = 0; i < count; i++){
+        float dl = a[i * 3] - b[i * 3];
+        float da = a[i * 3 + 1] - b[i * 3 + 1];
+        float db = a[i * 3 + 2] - b[i * 3 + 2];
+        float delta = sqrtf(dl * dl + da * da + db * db);
+        sum += delta;
+        if(delta > result.maxDelta) result.maxDelta = delta;
+        bool over = delta > tolerance;
+        if(over) result.differing++;
+
+        if(diff){
+            uint8_t * out = diff + i * 4;
+            if(over){
+                float strength = delta / 50.0f > 1 ? 1 : delta / 50.0f;
+                out[0] = 128 + 127 * strength;
+                out[1] = 0;
+                out[2] = 0;
+            } else {
+                uint8_t grey = a[i * 3] * 0.25f * 2.55f;
+                out[0] = out[1] = out[2] = grey;
+            }
+            out[3] = 255;
+        }
+    }
+    result.meanDelta = count > 0 ? sum / count : 0;
+    result.differingShare = count > 0 ? result.differing / (float)count : 0;
+    return result;
+}
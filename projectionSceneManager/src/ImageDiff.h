@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Perceptual comparison of two RGBA images of the same size.
+//
+// Both images are composited over black and blurred over 3x3 pixels, so
+// small antialiasing differences along edges do not count, then compared
+// as CIE Lab colour difference (deltaE 1976, about 2.3 is just noticeable).
+// Pixels differing by more than tolerance are counted. Independent of
+// openFrameworks.
+class ImageDiff {
+    public:
+        struct Result {
+            int differing;          // pixels over the tolerance
+            float differingShare;   // of all pixels
+            float maxDelta;
+            float meanDelta;
+        };
+
+        // diff, if given, receives an RGBA image: the expected image dimmed
+        // to grey with the differing pixels in red, brighter for larger errors
+        static Result compare(const uint8_t * expected, const uint8_t * actual, int width, int height,
+                              float tolerance, uint8_t * diff = 0);
+
+    private:
+        static void toLab(const uint8_t * rgba, int width, int height, std::vector<float> & lab);
+};
@@ -0,0 +1,228 @@
+#include "InputLog.h"
+#include "AsyncLog.h"
+#include "TimerWheel.h"
+#include <cstring>
+
+InputLog * InputLog::_instance = 0;
+
+InputLog * InputLog::instance(){
+    if(_instance == 0){
+        _instance = new InputLog();
+    }
+    return _instance;
+}
+
+InputLog::InputLog() : queue(256) {
+    recording = false;
+    recordStart = 0;
+    dropped = 0;
+    file = 0;
+    replaying = false;
+    length = 0;
+    replayStart = 0;
+    next = 0;
+}
+
+//--------------------------------------------------------------
+// Recording
+
+bool InputLog::startRecording(string path){
+    path = ofToDataPath(path, true);
+    file = fopen(path.c_str(), "w");
+    if(file == 0){
+        logError("could not record input to {}", path);
+        return false;
+    }
+    fputs("# projectionSceneManager input 1\n", file);
+    recordStart = TimerWheel::instance()->now();
+    recordedButtons.clear();
+    recording = true;
+    startThread();
+    logNotice("recording input to {}", path);
+    return true;
+}
+
+// marks a clean end, a recording without one ends with its last event
+void InputLog::stopRecording(){
+    if(!recording) return;
+    InputEvent end;
+    memset(&end, 0, sizeof(end));
+    end.type = InputEvent::END;
+    end.time = elapsed(TimerWheel::instance()->now());
+    queue.push(end);
+    recording = false;
+    waitForThread(true);
+    drain();
+    if(dropped > 0) logWarning("{} input events were not recorded, the queue was full", dropped.load());
+    fclose(file);
+    file = 0;
+}
+
+bool InputLog::isRecording(){
+    return recording;
+}
+
+// only changes are recorded, the sources read their button on every tick
+void InputLog::recordButton(const string & station, bool pressed){
+    if(!recording) return;
+    map<string, bool>::iterator it = recordedButtons.find(station);
+    if(it != recordedButtons.end() && it->second == pressed) return;
+    recordedButtons[station] = pressed;
+
+    InputEvent event;
+    memset(&event, 0, sizeof(event));
+    event.time = elapsed(TimerWheel::instance()->now());
+    event.type = InputEvent::BUTTON;
+    strncpy(event.station, station.c_str(), sizeof(event.station) - 1);
+    event.pressed = pressed;
+    if(!queue.push(event)) dropped++;
+}
+
+void InputLog::recordCue(const CueCommand & cue){
+    if(!recording) return;
+    InputEvent event;
+    memset(&event, 0, sizeof(event));
+    event.time = elapsed(TimerWheel::instance()->now());
+    event.type = InputEvent::CUE;
+    event.cue = cue;
+    if(!queue.push(event)) dropped++;
+}
+
+uint64_t InputLog::elapsed(uint64_t nowMillis){
+    return nowMillis > recordStart ? nowMillis - recordStart : 0;
+}
+
+void InputLog::threadedFunction(){
+    while(isThreadRunning()){
+        drain();
+        sleep(100);
+    }
+}
+
+// a crash loses at most the last tenth of a second
+void InputLog::drain(){
+    InputEvent event;
+    bool wrote = false;
+    while(queue.pop(event)){
+        fputs(format(event).c_str(), file);
+        fputc('\n', file);
+        wrote = true;
+    }
+    if(wrote) fflush(file);
+}
+
+//--------------------------------------------------------------
+// Replay
+
+bool InputLog::load(string path){
+    path = ofToDataPath(path, true);
+    ofBuffer buffer = ofBufferFromFile(path);
+    if(buffer.size() == 0){
+        logError("no input recording at {}", path);
+        return false;
+    }
+    events.clear();
+    length = 0;
+    int rejected = 0;
+    vector<string> lines = ofSplitString(buffer.getText(), "\n", true, true);
+    for(unsigned int i = 0; i < lines.size(); i++){
+        string & line = lines[i];
+        if(line[0] == '#') continue;
+        InputEvent event;
+        if(!parse(line, event)){
+            rejected++;
+            continue;
+        }
+        length = MAX(length, event.time);
+        if(event.type != InputEvent::END) events.push_back(event);
+    }
+    // edited files need not be in order
+    std::stable_sort(events.begin(), events.end(), [](const InputEvent & a, const InputEvent & b){ return a.time < b.time; });
+    if(rejected > 0) logWarning("{} lines of {} could not be read", rejected, path);
+    logNotice("replaying {} input events over {}s from {}", events.size(), length / 1000.0, path);
+    replaying = true;
+    return true;
+}
+
+bool InputLog::isReplaying(){
+    return replaying;
+}
+
+void InputLog::restart(uint64_t nowMillis){
+    replayStart = nowMillis;
+    next = 0;
+    buttons.clear();
+}
+
+bool InputLog::apply(uint64_t nowMillis, CueQueue & cues){
+    uint64_t time = nowMillis > replayStart ? nowMillis - replayStart : 0;
+    while(next < events.size() && events[next].time <= time){
+        InputEvent & event = events[next++];
+        if(event.type == InputEvent::BUTTON) buttons[event.station] = event.pressed;
+        else if(event.type == InputEvent::CUE){
+            CueCommand cue = event.cue;
+            cue.received = ofGetElapsedTimeMicros();
+            cues.push(cue);
+        }
+    }
+    return time < length;
+}
+
+bool InputLog::getButton(const string & station, bool & pressed){
+    if(!replaying) return false;
+    map<string, bool>::iterator it = buttons.find(station);
+    pressed = it != buttons.end() && it->second;
+    return true;
+}
+
+uint64_t InputLog::getLength(){
+    return length;
+}
+
+int InputLog::getNumEvents(){
+    return events.size();
+}
+
+//--------------------------------------------------------------
+// File format
+
+string InputLog::format(const InputEvent & event){
+    string line = ofToString(event.time) + "\t";
+    if(event.type == InputEvent::BUTTON){
+        return line + "button\t" + event.station + "\t" + (event.pressed ? "1" : "0");
+    }
+    if(event.type == InputEvent::END) return line + "end";
+
+    // the text commands of the CueControlServer
+    const CueCommand & cue = event.cue;
+    line += "cue\t";
+    if(cue.type == CueCommand::GOTO_PRESET) line += "preset " + ofToString(cue.index);
+    else if(cue.type == CueCommand::GOTO_SCENE) line += "scene " + ofToString(cue.index);
+    else if(cue.type == CueCommand::PAUSE) line += "pause";
+    else if(cue.type == CueCommand::RESUME) line += "resume";
+    else line += string("param ") + cue.source + ":" + cue.parameter + " " + ofToString(cue.value);
+    return line;
+}
+
+bool InputLog::parse(const string & line, InputEvent & event){
+    memset(&event, 0, sizeof(event));
+    vector<string> fields = ofSplitString(line, "\t");
+    if(fields.size() < 2) return false;
+    event.time = strtoull(fields[0].c_str(), 0, 10);
+
+    if(fields[1] == "end"){
+        event.type = InputEvent::END;
+        return true;
+    }
+    if(fields[1] == "button" && fields.size() == 4){
+        event.type = InputEvent::BUTTON;
+        strncpy(event.station, fields[2].c_str(), sizeof(event.station) - 1);
+        event.pressed = fields[3] == "1";
+        return true;
+    }
+    if(fields[1] == "cue" && fields.size() == 3){
+        event.type = InputEvent::CUE;
+        return CueControlServer::parseText(fields[2], event.cue);
+    }
+    return false;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ofMain.h"
+#include "CueControl.h"
+#include "SpscQueue.h"
+#include <atomic>
+
+// One recorded input, a button changing state or a remote cue
+struct InputEvent {
+    enum Type {
+        BUTTON,
+        CUE,
+        END
+    };
+
+    uint64_t time;      // millis since the recording started
+    Type type;
+    char station[48];   // BUTTON: the source name of the game station
+    bool pressed;
+    CueCommand cue;
+};
+
+// Records the button presses and the remote cues of a show, and plays them
+// back in place of the GPIO pins and the network.
+//
+//   bin/projectionSceneManager --record-input input.tsv
+//
+// The file is text, one event per line: the millis since the start, then
+// "button <station> <0|1>", "cue <command>" in the text form of the
+// CueControlServer, or "end" when the recording stopped cleanly. Events
+// are queued on the main thread and written by a background thread, a
+// press costs the show a copy into the queue.
+//
+// Replaying, the button state of each station follows the file and the
+// cues are pushed to the scene manager's queue at their time on the clock
+// passed to apply(). See SoakTest, which drives it.
+class InputLog : public ofThread {
+    public:
+        static InputLog * instance();
+
+        // Recording, times are taken from the TimerWheel like everything the sources see
+        bool startRecording(string path);
+        void stopRecording();
+        bool isRecording();
+        void recordButton(const string & station, bool pressed);
+        void recordCue(const CueCommand & cue);
+
+        // Replay
+        bool load(string path);
+        bool isReplaying();
+        void restart(uint64_t nowMillis);
+        // pushes the cues due by nowMillis, false once the recording is over
+        bool apply(uint64_t nowMillis, CueQueue & cues);
+        // the replayed state of a station's button, false when not replaying
+        bool getButton(const string & station, bool & pressed);
+        uint64_t getLength();
+        int getNumEvents();
+
+        static string format(const InputEvent & event);
+        static bool parse(const string & line, InputEvent & event);
+
+    private:
+        InputLog();
+
+        void threadedFunction();
+        void drain();
+        uint64_t elapsed(uint64_t nowMillis);
+
+        static InputLog * _instance;
+
+        // recording
+        std::atomic<bool> recording;
+        uint64_t recordStart;
+        map<string, bool> recordedButtons;
+        SpscQueue<InputEvent> queue;
+        std::atomic<int> dropped;
+        FILE * file;
+
+        // replay
+        bool replaying;
+        vector<InputEvent> events;
+        uint64_t length;
+        uint64_t replayStart;
+        unsigned int next;
+        map<string, bool> buttons;
+};
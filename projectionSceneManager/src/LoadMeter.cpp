@@ -0,0 +1,71 @@
+#include "LoadMeter.h"
+#include <time.h>
+#include <iomanip>
+
+LoadMeter::LoadMeter(){
+    mode = 0;
+    lastWall = 0;
+    lastCpu = 0;
+}
+
+void LoadMeter::setup(const vector<string> & _modeNames){
+    modeNames = _modeNames;
+    Totals zero = { 0, 0, 0 };
+    totals.assign(modeNames.size(), zero);
+    mode = 0;
+    lastWall = ofGetElapsedTimeMicros();
+    lastCpu = cpuNow();
+}
+
+// The time up to here still belongs to the old mode
+void LoadMeter::setMode(int _mode){
+    if(_mode == mode || _mode < 0 || _mode >= (int)totals.size()) return;
+    accumulate();
+    mode = _mode;
+}
+
+int LoadMeter::getMode(){
+    return mode;
+}
+
+void LoadMeter::frame(){
+    if(totals.empty()) return;
+    accumulate();
+    totals[mode].frames++;
+}
+
+void LoadMeter::accumulate(){
+    uint64_t wall = ofGetElapsedTimeMicros();
+    uint64_t cpu = cpuNow();
+    totals[mode].wallMicros += wall - lastWall;
+    totals[mode].cpuMicros += cpu - lastCpu;
+    lastWall = wall;
+    lastCpu = cpu;
+}
+
+float LoadMeter::getFrameRate(int _mode){
+    if(_mode < 0 || _mode >= (int)totals.size() || totals[_mode].wallMicros == 0) return 0;
+    return totals[_mode].frames * 1000000.0 / totals[_mode].wallMicros;
+}
+
+float LoadMeter::getCpuLoad(int _mode){
+    if(_mode < 0 || _mode >= (int)totals.size() || totals[_mode].wallMicros == 0) return 0;
+    return 100.0 * totals[_mode].cpuMicros / totals[_mode].wallMicros;
+}
+
+string LoadMeter::getStatsString(){
+    stringstream out;
+    out << std::fixed << std::setprecision(1);
+    for(unsigned int i = 0; i < totals.size(); i++){
+        if(i > 0) out << ", ";
+        out << modeNames[i] << " " << totals[i].wallMicros / 1000000 << "s: "
+            << getFrameRate(i) << " fps, " << getCpuLoad(i) << "% cpu";
+    }
+    return out.str();
+}
+
+uint64_t LoadMeter::cpuNow(){
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
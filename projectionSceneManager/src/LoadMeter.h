@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ofMain.h"
+
+// Frame rate and CPU use, kept apart for each mode a source runs in.
+//
+// frame() is called once per frame. It adds the wall and process CPU time
+// since the last call to the current mode, so switching modes with
+// setMode() needs no bookkeeping by the caller. CPU load is in percent of
+// one core, all threads of the process included.
+class LoadMeter {
+    public:
+        LoadMeter();
+
+        // names the modes for getStatsString(), their count too
+        void setup(const vector<string> & _modeNames);
+        void setMode(int mode);
+        int getMode();
+        void frame();
+
+        float getFrameRate(int mode);
+        float getCpuLoad(int mode);
+        string getStatsString();
+
+    private:
+        struct Totals {
+            uint64_t wallMicros;
+            uint64_t cpuMicros;
+            uint64_t frames;
+        };
+
+        void accumulate();
+        static uint64_t cpuNow();
+
+        vector<string> modeNames;
+        vector<Totals> totals;
+        int mode;
+        uint64_t lastWall;
+        uint64_t lastCpu;
+};
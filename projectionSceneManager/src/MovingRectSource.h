@@ -1,17 +1,15 @@
 #pragma once
 
 #include "ofMain.h"
-#include "FboSource.h"
+#include "ShaderFboSource.h"
 
-class MovingRectSource : public ofx::piMapper::FboSource {
+class MovingRectSource : public ShaderFboSource {
 	public:
         void setup();
 		void update();
-		void draw();
         void reset();
-        void drawMovingRect(int, int, int, int, float);
+        void setUniforms(ofShader & s);
         void setName(string _name);
         void setColor(ofColor);
         ofColor rectColor;
-        float time;
 };
@@ -0,0 +1,182 @@
+#include "PaletteTimeline.h"
+
+// rows per blended segment, held segments need a single one
+static const int blendSamples = 64;
+
+PaletteTimeline::PaletteTimeline(){
+    gradientCount = 0;
+    gradientFrom = 0;
+    gradientTo = 1;
+    numColors = 0;
+    cycleStart = 0;
+    key = 0;
+    current = NULL;
+}
+
+void PaletteTimeline::setGradient(int count, float from, float to){
+    gradientCount = count;
+    gradientFrom = from;
+    gradientTo = to;
+}
+
+static ofColor colorFromJson(const Json::Value & value){
+    int alpha = value.size() > 3 ? value[3u].asInt() : 255;
+    return ofColor(value[0u].asInt(), value[1u].asInt(), value[2u].asInt(), alpha);
+}
+
+bool PaletteTimeline::load(string path, string _name){
+    name = _name;
+    keys.clear();
+
+    ofxJSONElement json;
+    if(!json.open(path) || !json.isMember(name) || json[name]["keys"].size() == 0){
+        ofLogError("PaletteTimeline") << "no keyframes for " << name << " in " << path;
+        // keep drawing in plain white rather than failing later
+        Key fallback;
+        fallback.endMin = fallback.endMax = 1000;
+        fallback.blend = false;
+        fallback.flag = false;
+        fallback.colors.push_back(ofColor(255));
+        keys.push_back(fallback);
+        compile();
+        return false;
+    }
+
+    const Json::Value & entries = json[name]["keys"];
+    for(unsigned int i = 0; i < entries.size(); i++){
+        const Json::Value & entry = entries[i];
+        Key k;
+        if(entry["end"].isArray()){
+            k.endMin = entry["end"][0u].asInt();
+            k.endMax = entry["end"][1u].asInt();
+        } else {
+            k.endMin = k.endMax = entry["end"].asInt();
+        }
+        k.blend = entry["blend"].asBool();
+        k.flag = entry["flag"].asBool();
+        for(unsigned int c = 0; c < entry["colors"].size(); c++){
+            k.colors.push_back(colorFromJson(entry["colors"][c]));
+        }
+        if(k.colors.empty()) k.colors.push_back(ofColor(255));
+        keys.push_back(k);
+    }
+    compile();
+    return true;
+}
+
+// Every row is final: blends between keyframes and the gradient steps are
+// worked out here once instead of per frame and per ring
+void PaletteTimeline::compile(){
+    numColors = gradientCount > 0 ? gradientCount : 1;
+    if(gradientCount <= 0){
+        for(unsigned int i = 0; i < keys.size(); i++) numColors = MAX(numColors, (int)keys[i].colors.size());
+    }
+
+    table.assign(keys.size(), vector<ofColor>());
+    samples.assign(keys.size(), 1);
+
+    for(unsigned int i = 0; i < keys.size(); i++){
+        Key & from = keys[i];
+        Key & to = keys[(i + 1) % keys.size()];
+        samples[i] = from.blend ? blendSamples : 1;
+        table[i].resize(samples[i] * numColors);
+
+        for(int s = 0; s < samples[i]; s++){
+            float t = samples[i] > 1 ? s / (float)(samples[i] - 1) : 0;
+            // the two keyframe colours at this point of the segment
+            ofColor a = from.colors[0].getLerped(to.colors[0], t);
+            ofColor b = from.colors[MIN(1, (int)from.colors.size() - 1)]
+                .getLerped(to.colors[MIN(1, (int)to.colors.size() - 1)], t);
+
+            for(int c = 0; c < numColors; c++){
+                ofColor & out = table[i][s * numColors + c];
+                if(gradientCount > 0){
+                    float amount = gradientCount > 1
+                        ? gradientFrom + (gradientTo - gradientFrom) * c / (float)(gradientCount - 1)
+                        : gradientFrom;
+                    out = a.getLerped(b, amount);
+                } else {
+                    int fc = MIN(c, (int)from.colors.size() - 1);
+                    int tc = MIN(c, (int)to.colors.size() - 1);
+                    out = from.colors[fc].getLerped(to.colors[tc], t);
+                }
+            }
+        }
+    }
+
+    ends.assign(keys.size(), 0);
+    rollEnds();
+    key = 0;
+    current = &table[0][0];
+}
+
+void PaletteTimeline::rollEnds(){
+    for(unsigned int i = 0; i < keys.size(); i++){
+        ends[i] = keys[i].endMin == keys[i].endMax ? keys[i].endMin : (int)ofRandom(keys[i].endMin, keys[i].endMax);
+        // segments never run backwards, whatever the ranges in the file
+        if(i > 0) ends[i] = MAX(ends[i], ends[i - 1]);
+    }
+}
+
+void PaletteTimeline::restart(uint64_t nowMillis){
+    cycleStart = nowMillis;
+    rollEnds();
+    key = 0;
+    current = &table[0][0];
+}
+
+// A resumed cycle may have started before the clock did
+void PaletteTimeline::resume(uint64_t nowMillis, int elapsed){
+    restart(nowMillis);
+    cycleStart = (int64_t)nowMillis - MAX(0, elapsed);
+}
+
+int PaletteTimeline::getCycleElapsed(uint64_t nowMillis){
+    return (int64_t)nowMillis - cycleStart;
+}
+
+void PaletteTimeline::update(uint64_t nowMillis){
+    if(keys.empty()) return;
+    if((int64_t)nowMillis < cycleStart) restart(nowMillis);
+
+    int elapsed = (int64_t)nowMillis - cycleStart;
+    // the segment only ever moves forward within a cycle
+    while(key < (int)keys.size() && elapsed >= ends[key]) key++;
+    if(key == (int)keys.size()){
+        // a new cycle starts where the last one ended, with fresh lengths
+        int64_t length = MAX(1, ends.back());
+        cycleStart += ((int64_t)nowMillis - cycleStart) / length * length;
+        rollEnds();
+        key = 0;
+        elapsed = (int64_t)nowMillis - cycleStart;
+        while(key < (int)keys.size() - 1 && elapsed >= ends[key]) key++;
+    }
+
+    int start = key > 0 ? ends[key - 1] : 0;
+    int row = 0;
+    if(samples[key] > 1 && ends[key] > start){
+        row = (elapsed - start) * (samples[key] - 1) / (ends[key] - start);
+        row = MIN(row, samples[key] - 1);
+    }
+    current = &table[key][row * numColors];
+}
+
+const ofColor & PaletteTimeline::getColor(int index){
+    return current[MAX(0, MIN(index, numColors - 1))];
+}
+
+int PaletteTimeline::getNumColors(){
+    return numColors;
+}
+
+bool PaletteTimeline::isFlagged(){
+    return keys[key].flag;
+}
+
+int PaletteTimeline::getKeyIndex(){
+    return key;
+}
+
+float PaletteTimeline::getCycleLength(){
+    return ends.empty() ? 0 : ends.back();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxJSON.h"
+
+// Looping colour animation built from keyframes in a JSON file.
+//
+// Each keyframe holds a set of colours and the time its segment ends,
+// either fixed or as a [min, max] range that is rolled at the start of
+// every cycle. A segment holds its colours, or blends towards the next
+// keyframe if "blend" is set. Keyframes may carry a flag, the game logic
+// reads it through isFlagged() instead of comparing colours.
+//
+// load() compiles every segment into a lookup table of ready colours
+// (including the gradient steps set with setGradient()), so update() is a
+// table lookup by phase and getColor() a plain read, whatever the number
+// of colours drawn.
+class PaletteTimeline {
+    public:
+        PaletteTimeline();
+
+        // Expands the two keyframe colours into count colours, colour i
+        // being the lerp at from + (to - from) * i / (count - 1).
+        // Call before load().
+        void setGradient(int count, float from, float to);
+
+        bool load(string path, string name);
+        void restart(uint64_t nowMillis);
+        // continues a cycle elapsed millis in, after a snapshot (the
+        // segment lengths are rolled again)
+        void resume(uint64_t nowMillis, int elapsed);
+        int getCycleElapsed(uint64_t nowMillis);
+        void update(uint64_t nowMillis);
+
+        const ofColor & getColor(int index);
+        int getNumColors();
+        bool isFlagged();
+        int getKeyIndex();
+        float getCycleLength();
+
+    private:
+        struct Key {
+            int endMin, endMax;
+            bool blend;
+            bool flag;
+            vector<ofColor> colors;
+        };
+
+        void compile();
+        void rollEnds();
+
+        string name;
+        vector<Key> keys;
+
+        int gradientCount;
+        float gradientFrom, gradientTo;
+        int numColors;
+
+        // table[key] holds samples[key] rows of numColors colours
+        vector< vector<ofColor> > table;
+        vector<int> samples;
+
+        vector<int> ends;
+        int64_t cycleStart;  // may lie before the clock started, see resume()
+        int key;
+        const ofColor * current;
+};
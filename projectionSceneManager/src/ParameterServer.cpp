@@ -0,0 +1,137 @@
+#include "ParameterServer.h"
+#include "Settings.h"
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+ParameterServer::ParameterServer() : requests(64) {
+    listenFd = -1;
+}
+
+ParameterServer::~ParameterServer(){
+    exit();
+}
+
+bool ParameterServer::setup(string _path){
+#ifdef __linux__
+    path = _path;
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)){
+        ofLogError("ParameterServer") << "socket path too long: " << path;
+        return false;
+    }
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    // a socket file left over from a crashed run is replaced, one that
+    // still answers belongs to another instance
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool live = probe >= 0 && connect(probe, (sockaddr *)&address, sizeof(address)) == 0;
+    if(probe >= 0) close(probe);
+    if(live){
+        ofLogError("ParameterServer") << path << " is in use by another instance, not listening";
+        return false;
+    }
+    unlink(path.c_str());
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listenFd < 0 || bind(listenFd, (sockaddr *)&address, sizeof(address)) < 0 || listen(listenFd, 8) < 0){
+        ofLogError("ParameterServer") << "could not listen on " << path;
+        if(listenFd >= 0) close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    ofLogNotice("ParameterServer") << "parameters can be changed through " << path;
+    startThread();
+    return true;
+#else
+    ofLogWarning("ParameterServer") << "runtime parameters need unix sockets, not available here";
+    return false;
+#endif
+}
+
+void ParameterServer::exit(){
+#ifdef __linux__
+    if(listenFd < 0) return;
+    waitForThread(true);
+    close(listenFd);
+    unlink(path.c_str());
+    listenFd = -1;
+    Request request;
+    while(requests.pop(request)) close(request.client);
+#endif
+}
+
+// Main thread
+void ParameterServer::update(){
+#ifdef __linux__
+    Request request;
+    while(requests.pop(request)){
+        string reply;
+        vector<string> lines = ofSplitString(request.text, "\n", true, true);
+        for(unsigned int i = 0; i < lines.size(); i++) reply += handle(lines[i]);
+        // small enough for the socket buffer, never blocks for long
+        send(request.client, reply.c_str(), reply.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(request.client);
+    }
+#endif
+}
+
+string ParameterServer::handle(string line){
+    Settings * settings = Settings::instance();
+    size_t space = line.find(' ');
+    string verb = line.substr(0, space);
+    string rest = space == string::npos ? "" : ofTrim(line.substr(space + 1));
+
+    if(verb == "list") return settings->listParameters();
+    if(verb == "get"){
+        string value;
+        if(!settings->getParameter(rest, value)) return "error: unknown parameter " + rest + "\n";
+        return rest + " = " + value + "\n";
+    }
+    if(verb == "set"){
+        // keys have spaces, the value is the last word
+        size_t valueStart = rest.rfind(' ');
+        if(valueStart == string::npos) return "error: set <source>:<parameter> <value>\n";
+        string key = rest.substr(0, valueStart);
+        string error;
+        if(!settings->setParameter(key, rest.substr(valueStart + 1), error)) return "error: " + error + "\n";
+        string value;
+        settings->getParameter(key, value);
+        ofLogNotice("ParameterServer") << key << " set to " << value;
+        return key + " = " + value + "\n";
+    }
+    return "error: unknown command " + verb + ", expected list, get or set\n";
+}
+
+void ParameterServer::threadedFunction(){
+#ifdef __linux__
+    while(isThreadRunning()){
+        pollfd listening = { listenFd, POLLIN, 0 };
+        if(poll(&listening, 1, 500) <= 0) continue;
+        int client = accept(listenFd, NULL, NULL);
+        if(client >= 0) readClient(client);
+    }
+#endif
+}
+
+// Reads until the client closes its end or pauses, one client at a time
+void ParameterServer::readClient(int client){
+#ifdef __linux__
+    Request request;
+    request.client = client;
+    size_t used = 0;
+    while(used < sizeof(request.text) - 1){
+        pollfd readable = { client, POLLIN, 0 };
+        if(poll(&readable, 1, 200) <= 0) break;
+        ssize_t size = read(client, request.text + used, sizeof(request.text) - 1 - used);
+        if(size <= 0) break;
+        used += size;
+    }
+    request.text[used] = 0;
+    if(used == 0 || !requests.push(request)) close(client);
+#endif
+}
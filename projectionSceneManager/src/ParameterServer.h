@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SpscQueue.h"
+
+// Local control socket for the runtime parameters in Settings.
+//
+// A unix stream socket, one command per line, the answer comes back on the
+// same connection before it is closed:
+//   list
+//   get Waterfall Game FBO Source:particles
+//   set Waterfall Game FBO Source:particles 40
+// e.g. echo "list" | nc -U /tmp/projectionSceneManager.sock
+//
+// Only opened when started with --param-socket <path>. Every instance on a
+// machine needs its own path, setup() fails when another instance is
+// already listening on it.
+//
+// Connections are read on a background thread. The commands are applied
+// and answered by update() on the main thread, where the sources live.
+class ParameterServer : public ofThread {
+    public:
+        ParameterServer();
+        ~ParameterServer();
+
+        bool setup(string _path);
+        void exit();
+        void update();
+
+        static string handle(string line);
+
+    private:
+        struct Request {
+            int client;
+            char text[512];
+        };
+
+        void threadedFunction();
+        void readClient(int client);
+
+        string path;
+        int listenFd;
+        SpscQueue<Request> requests;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+// Header-only particle core shared by the particle effects of the sources.
+// An effect is a specialization built from a particle type and four
+// compile-time policies, each a plain class with inline members:
+//
+//   Emitter   void emit(P & p, int index)       set up a newly created particle
+//             void revive(P & p, int index)     (optional) bring a particle back, see reviveAll()
+//   Force     bool step(P & p)                  apply forces and integrate one tick,
+//                                               return false to take the particle out
+//   Boundary  void apply(P & p)                 keep a live particle inside its area
+//   Renderer  void draw(P * p, int count)       draw the live particles
+//
+// Per-frame inputs (time, game state, colours) are set on the policy objects
+// before update() / draw(), so nothing in the inner loops tests runtime flags.
+// A different force can be passed to update() to switch behaviour for a whole
+// frame. Particles taken out are swapped behind the live range rather than
+// flagged, so the loops never skip dead particles either.
+template<typename P, typename Force, typename Boundary, typename Emitter, typename Renderer>
+class ParticleSystem {
+    public:
+        ParticleSystem(){
+            numAlive = 0;
+        }
+
+        void spawn(int count){
+            particles.resize(count);
+            for(int i = 0; i < count; i++){
+                emitter.emit(particles[i], i);
+            }
+            numAlive = count;
+        }
+
+        // Grows or shrinks the pool and keeps the particles that stay.
+        // New particles are emitted and join the live range.
+        void resize(int count){
+            int old = particles.size();
+            if(count < old){
+                particles.resize(count);
+                numAlive = std::min(numAlive, count);
+                return;
+            }
+            particles.resize(count);
+            for(int i = old; i < count; i++){
+                emitter.emit(particles[i], i);
+                std::swap(particles[i], particles[numAlive]);
+                numAlive++;
+            }
+        }
+
+        void reviveAll(){
+            for(int i = 0; i < (int)particles.size(); i++){
+                emitter.revive(particles[i], i);
+            }
+            numAlive = particles.size();
+        }
+
+        void update(){
+            update(force);
+        }
+
+        template<typename F>
+        void update(F & f){
+            P * p = particles.data();
+            for(int i = 0; i < numAlive; ){
+                if(f.step(p[i])){
+                    boundary.apply(p[i]);
+                    i++;
+                } else {
+                    kill(i);
+                }
+            }
+        }
+
+        void draw(){
+            renderer.draw(particles.data(), numAlive);
+        }
+
+        void kill(int i){
+            numAlive--;
+            std::swap(particles[i], particles[numAlive]);
+        }
+
+        P * data(){
+            return particles.data();
+        }
+
+        int size(){
+            return particles.size();
+        }
+
+        int alive(){
+            return numAlive;
+        }
+
+        std::vector<P> particles;
+        int numAlive;
+
+        Force force;
+        Boundary boundary;
+        Emitter emitter;
+        Renderer renderer;
+};
+
+// Policy that does nothing, for effects that need no boundary or no renderer
+struct NoParticlePolicy {
+    template<typename P> void apply(P & p){}
+    template<typename P> void emit(P & p, int index){}
+    template<typename P> void revive(P & p, int index){}
+    template<typename P> void draw(P * p, int count){}
+};
@@ -0,0 +1,118 @@
+#include "RenderBenchmark.h"
+#include "ofxJSON.h"
+
+RenderBenchmark::RenderBenchmark(){
+    piMapper = NULL;
+    running = false;
+    frames = 0;
+    warmupFrames = 0;
+    startMillis = 0;
+    frameCount = 0;
+    frameStart = 0;
+    preset = 0;
+    presetFrame = 0;
+}
+
+void RenderBenchmark::setup(ofxPiMapper * _piMapper, int _frames, int _warmupFrames, string _outPath, uint64_t _startMillis){
+    piMapper = _piMapper;
+    startMillis = _startMillis;
+    frames = MAX(1, _frames);
+    warmupFrames = MAX(0, _warmupFrames);
+    outPath = _outPath;
+    target.allocate(ofGetWidth(), ofGetHeight(), GL_RGBA);
+    running = true;
+    results.clear();
+    ofLogNotice("RenderBenchmark") << piMapper->getNumPresets() << " presets, " << warmupFrames << " + "
+                                   << frames << " frames each at " << ofGetWidth() << "x" << ofGetHeight();
+    startPreset(0);
+}
+
+bool RenderBenchmark::isRunning(){
+    return running;
+}
+
+uint64_t RenderBenchmark::now(){
+    return startMillis + frameCount * 1000 / 60;
+}
+
+void RenderBenchmark::startPreset(int _preset){
+    preset = _preset;
+    presetFrame = 0;
+    piMapper->setPreset(preset);
+    PresetResult result;
+    result.preset = preset;
+    results.push_back(result);
+}
+
+void RenderBenchmark::beginFrame(){
+    if(!running) return;
+    frameStart = ofGetElapsedTimeMicros();
+}
+
+void RenderBenchmark::beginDraw(){
+    if(!running) return;
+    target.begin();
+    ofClear(0);
+}
+
+void RenderBenchmark::endDraw(){
+    if(!running) return;
+    target.end();
+    // the frame is only done once the GPU (or llvmpipe) is
+    glFinish();
+    float millis = (ofGetElapsedTimeMicros() - frameStart) / 1000.0f;
+
+    if(presetFrame >= warmupFrames) results.back().frameMillis.push_back(millis);
+    presetFrame++;
+    frameCount++;
+
+    if(presetFrame < warmupFrames + frames) return;
+    if(preset + 1 < piMapper->getNumPresets()) startPreset(preset + 1);
+    else finish();
+}
+
+static float percentile(vector<float> & sorted, float p){
+    if(sorted.empty()) return 0;
+    int index = MIN((int)sorted.size() - 1, (int)(p * sorted.size()));
+    return sorted[index];
+}
+
+void RenderBenchmark::finish(){
+    running = false;
+
+    ofxJSONElement report;
+    report["renderer"] = string((const char *)glGetString(GL_RENDERER));
+    report["width"] = ofGetWidth();
+    report["height"] = ofGetHeight();
+    report["frames"] = frames;
+    report["warmupFrames"] = warmupFrames;
+    for(unsigned int r = 0; r < results.size(); r++){
+        vector<float> & times = results[r].frameMillis;
+        double sum = 0, sumSquares = 0;
+        for(unsigned int i = 0; i < times.size(); i++){
+            sum += times[i];
+            sumSquares += times[i] * times[i];
+        }
+        double mean = times.empty() ? 0 : sum / times.size();
+        double variance = times.empty() ? 0 : sumSquares / times.size() - mean * mean;
+        sort(times.begin(), times.end());
+
+        ofxJSONElement entry;
+        entry["preset"] = results[r].preset;
+        entry["frames"] = (int)times.size();
+        entry["meanMillis"] = mean;
+        entry["stddevMillis"] = sqrt(MAX(0.0, variance));
+        entry["minMillis"] = times.empty() ? 0 : times.front();
+        entry["medianMillis"] = percentile(times, 0.5);
+        entry["p95Millis"] = percentile(times, 0.95);
+        entry["p99Millis"] = percentile(times, 0.99);
+        entry["maxMillis"] = times.empty() ? 0 : times.back();
+        report["presets"].append(entry);
+        ofLogNotice("RenderBenchmark") << "preset " << results[r].preset << ": mean " << mean << "ms, p99 "
+                                       << percentile(times, 0.99) << "ms";
+    }
+
+    if(report.save(outPath, true)) ofLogNotice("RenderBenchmark") << "wrote " << outPath;
+    else ofLogError("RenderBenchmark") << "could not write " << outPath;
+    ofExit(0);
+}
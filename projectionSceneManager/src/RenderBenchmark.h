@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxPiMapper.h"
+
+// End to end frame cost of a show, without a projector.
+//
+//   xvfb-run -a bin/projectionSceneManager --bench-render 600 --bench-out bench.json
+//   (add --data <show data folder> for another ofxpimapper.xml and scenes.json)
+//
+// The app runs with every source and surface, but the scene timeline is
+// paused and the benchmark steps through the presets itself: a few warmup
+// frames, then the measured ones. The clock advances a fixed 1/60 s per
+// frame, so every run simulates the same thing whatever the machine. The
+// frame is drawn into an offscreen FBO and glFinish()ed, the time from the
+// start of update() to the finished frame is the frame time. Under Mesa
+// llvmpipe that includes all the rasterising.
+//
+// The statistics per preset go to a JSON file for the build server, then
+// the app quits.
+class RenderBenchmark {
+    public:
+        RenderBenchmark();
+
+        // the fixed clock carries on from startMillis
+        void setup(ofxPiMapper * _piMapper, int _frames, int _warmupFrames, string _outPath, uint64_t _startMillis);
+        bool isRunning();
+
+        // the fixed clock, millis
+        uint64_t now();
+
+        // start of ofApp::update()
+        void beginFrame();
+        // around the drawing in ofApp::draw()
+        void beginDraw();
+        void endDraw();
+
+    private:
+        struct PresetResult {
+            int preset;
+            vector<float> frameMillis;
+        };
+
+        void startPreset(int preset);
+        void finish();
+
+        ofxPiMapper * piMapper;
+        bool running;
+        int frames;
+        int warmupFrames;
+        string outPath;
+
+        ofFbo target;
+        uint64_t startMillis;
+        uint64_t frameCount;
+        uint64_t frameStart;
+        int preset;
+        int presetFrame;
+        vector<PresetResult> results;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <functional>
+
+// Process-wide cache of read-only resources, shared by every instance that
+// asks for the same key. The cache only holds weak references: a resource
+// is created by the first get() and freed when the last instance holding
+// it goes away, so the memory of N instances grows with their own state
+// only.
+template<typename T>
+class ResourceCache {
+    public:
+        static std::shared_ptr<T> get(const std::string & key, std::function<T * ()> create){
+            std::weak_ptr<T> & entry = entries()[key];
+            std::shared_ptr<T> resource = entry.lock();
+            if(!resource){
+                resource = std::shared_ptr<T>(create());
+                entry = resource;
+            }
+            return resource;
+        }
+
+        // Resources still in use, entries of freed ones are dropped here
+        static int getNumLive(){
+            int live = 0;
+            typename std::map<std::string, std::weak_ptr<T> >::iterator it = entries().begin();
+            while(it != entries().end()){
+                if(it->second.expired()){
+                    entries().erase(it++);
+                } else {
+                    live++;
+                    ++it;
+                }
+            }
+            return live;
+        }
+
+    private:
+        static std::map<std::string, std::weak_ptr<T> > & entries(){
+            static std::map<std::string, std::weak_ptr<T> > cache;
+            return cache;
+        }
+};
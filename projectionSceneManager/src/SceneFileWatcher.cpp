@@ -0,0 +1,145 @@
+#include "SceneFileWatcher.h"
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+SceneFileWatcher::SceneFileWatcher(){
+    lastModified = 0;
+    numPresets = 0;
+    hasPending = false;
+    inotifyFd = -1;
+    watchFd = -1;
+}
+
+SceneFileWatcher::~SceneFileWatcher(){
+    exit();
+}
+
+void SceneFileWatcher::watch(string _path){
+    path = ofToDataPath(_path, true);
+    directory = ofFilePath::getEnclosingDirectory(path, false);
+    fileName = ofFilePath::getFileName(path);
+
+    struct stat info;
+    if(stat(path.c_str(), &info) == 0) lastModified = info.st_mtime;
+
+#ifdef __linux__
+    // editors often save through a temporary file and a rename, so the
+    // directory is watched rather than the file itself
+    inotifyFd = inotify_init1(IN_NONBLOCK);
+    if(inotifyFd >= 0){
+        watchFd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    }
+    if(watchFd < 0) ofLogWarning("SceneFileWatcher") << "inotify not available, polling " << path;
+#endif
+    startThread();
+}
+
+void SceneFileWatcher::exit(){
+    if(!isThreadRunning()) return;
+    waitForThread(true);
+#ifdef __linux__
+    if(inotifyFd >= 0) close(inotifyFd);
+    inotifyFd = -1;
+    watchFd = -1;
+#endif
+}
+
+void SceneFileWatcher::setNumPresets(int count){
+    numPresets = count;
+}
+
+bool SceneFileWatcher::fetch(ofxJSONElement & scenes, string & error){
+    lock();
+    bool changed = hasPending;
+    if(changed){
+        error = pendingError;
+        if(error.empty()) scenes = pendingScenes;
+        pendingScenes = ofxJSONElement();
+        hasPending = false;
+    }
+    unlock();
+    return changed;
+}
+
+void SceneFileWatcher::threadedFunction(){
+    while(isThreadRunning()){
+        waitForChange();
+    }
+}
+
+// Returns after a change to the scene file was loaded, or after half a
+// second so the thread can be stopped
+void SceneFileWatcher::waitForChange(){
+#ifdef __linux__
+    if(watchFd >= 0){
+        struct pollfd fd;
+        fd.fd = inotifyFd;
+        fd.events = POLLIN;
+        if(poll(&fd, 1, 500) <= 0) return;
+
+        bool ours = false;
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t size;
+        while((size = read(inotifyFd, buffer, sizeof(buffer))) > 0){
+            for(char * p = buffer; p < buffer + size; ){
+                struct inotify_event * event = (struct inotify_event *)p;
+                if(event->len > 0 && fileName == event->name) ours = true;
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if(!ours) return;
+        // let the editor finish writing before reading
+        sleep(100);
+        while(read(inotifyFd, buffer, sizeof(buffer)) > 0){}
+        load();
+        return;
+    }
+#endif
+    sleep(500);
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0 || info.st_mtime == lastModified) return;
+    lastModified = info.st_mtime;
+    load();
+}
+
+void SceneFileWatcher::load(){
+    ofxJSONElement scenes;
+    string error;
+    if(!scenes.open(path)){
+        error = "could not parse " + path;
+    } else {
+        validate(scenes, error);
+    }
+
+    lock();
+    pendingScenes = scenes;
+    pendingError = error;
+    hasPending = true;
+    unlock();
+}
+
+bool SceneFileWatcher::validate(ofxJSONElement & scenes, string & error){
+    if(!scenes.isArray() || scenes.size() == 0){
+        error = "expected a non empty list of scenes";
+        return false;
+    }
+    int presets = numPresets;
+    for(unsigned int i = 0; i < scenes.size(); i++){
+        const Json::Value & scene = scenes[i];
+        if(!scene.isObject() || !scene["preset"].isInt() || !scene["duration"].isNumeric()){
+            error = "scene " + ofToString(i) + " needs a numeric preset and duration";
+            return false;
+        }
+        int preset = scene["preset"].asInt();
+        if(preset < 0 || preset >= presets){
+            error = "scene " + ofToString(i) + " refers to preset " + ofToString(preset)
+                + " but there are only " + ofToString(presets);
+            return false;
+        }
+    }
+    return true;
+}
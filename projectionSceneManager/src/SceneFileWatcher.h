@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxJSON.h"
+#include <atomic>
+
+// Watches the scene file from a background thread (inotify on Linux, mtime
+// polling elsewhere). A changed file is parsed and validated on that
+// thread too, the render thread only picks up a finished timeline with
+// fetch() and never touches the disk or the parser.
+class SceneFileWatcher : public ofThread {
+    public:
+        SceneFileWatcher();
+        ~SceneFileWatcher();
+
+        void watch(string _path);
+        void exit();
+
+        // presets the scenes may refer to, updated by the main thread
+        void setNumPresets(int count);
+
+        // true if the file changed since the last call. scenes is only
+        // replaced if the new file is valid, otherwise error says why.
+        bool fetch(ofxJSONElement & scenes, string & error);
+
+    private:
+        void threadedFunction();
+        void waitForChange();
+        void load();
+        bool validate(ofxJSONElement & scenes, string & error);
+
+        string path;
+        string directory;
+        string fileName;
+        time_t lastModified;
+
+        std::atomic<int> numPresets;
+
+        // written by the watcher thread, taken under lock
+        ofxJSONElement pendingScenes;
+        string pendingError;
+        bool hasPending;
+
+        int inotifyFd;
+        int watchFd;
+};
@@ -4,47 +4,268 @@
 void SceneManager::setup(string scenesFile, ofxPiMapper *_piMapper){
     piMapper = _piMapper;
     if (result.open(scenesFile)){
-        cout << "file opened successfully" << endl;
+        logNotice("file opened successfully");
         allowTransitions = true;
     }
     else {
-        cout << "scene file " << scenesFile << " not found" << endl;
+        logNotice("scene file {} not found", scenesFile);
         allowTransitions = false;
     }
     sceneIndex = 0;
+    sceneTimer = 0;
+    paused = false;
+    pausedRemaining = 0;
+    cueCount = 0;
+    cueLatencyLast = cueLatencyMax = cueLatencySum = 0;
+    cueLatencyMin = UINT64_MAX;
     currentPreset = result[sceneIndex]["preset"].asInt();
     sceneDuration = result[sceneIndex]["duration"].asInt();
 
     if (sceneDuration<=0) {
         allowTransitions = false;
-        cout << "scene duration set to <= 0, therefore transitions turned off." << endl;
+        logNotice("scene duration set to <= 0, therefore transitions turned off.");
     }
+    // sceneDuration is the app time at which the current scene ends
+    if (allowTransitions) {
+        sceneTimer = TimerWheel::instance()->scheduleAt(sceneDuration, [this](){ nextScene(); });
+    }
+
+    // edits to the scene file are picked up while running
+    sceneWatcher.setNumPresets(piMapper->getNumPresets());
+    sceneWatcher.watch(scenesFile);
 }
 
 // Don't do any drawing here
+// Scene changes are fired by the timer wheel, only remote cues are picked up here
 void SceneManager::update(){
-    if (ofGetElapsedTimeMillis()>sceneDuration && allowTransitions) {
+    TRACE_ZONE("SceneManager::update");
+    // the file was parsed and checked on the watcher thread already
+    ofxJSONElement scenes;
+    string error;
+    sceneWatcher.setNumPresets(piMapper->getNumPresets());
+    if (sceneWatcher.fetch(scenes, error)) {
+        if (error.empty()) reloadScenes(scenes);
+        else logError("scene file not reloaded, {}", error);
+    }
+
+    CueCommand cue;
+    while (cues.pop(cue)) {
+        InputLog::instance()->recordCue(cue);
+        applyCue(cue);
+        uint64_t latency = ofGetElapsedTimeMicros() - cue.received;
+        cueCount++;
+        cueLatencyLast = latency;
+        cueLatencyMin = MIN(cueLatencyMin, latency);
+        cueLatencyMax = MAX(cueLatencyMax, latency);
+        cueLatencySum += latency;
+    }
+}
+
+void SceneManager::nextScene(){
+    TRACE_ZONE("SceneManager::nextScene");
+    if (allowTransitions) {
         sceneIndex++;
         if (sceneIndex >= result.size()) {
-            cout << "Warning: end of scenes reached. Restarting from 0." << endl;
+            logWarning("end of scenes reached. Restarting from 0.");
             sceneIndex = 0;
         }
 
         int targetPreset = result[sceneIndex]["preset"].asInt();
 
         if (targetPreset>=piMapper->getNumPresets()){
-            cout << "ERROR: skipping scene " << sceneIndex << " as preset " << targetPreset << " does not exist" << endl;
+            logError("skipping scene {} as preset {} does not exist", sceneIndex, targetPreset);
+            sceneTimer = TimerWheel::instance()->schedule(0, [this](){ nextScene(); });
         }
         else {
             piMapper->setPreset(targetPreset);
             int tempDuration = result[sceneIndex]["duration"].asInt();
             if (tempDuration<=0){
                 allowTransitions = false;
-                cout << "scene duration set to <= 0, therefore transitions turned off." << endl;
+                logNotice("scene duration set to <= 0, therefore transitions turned off.");
                 return;
             }
             sceneDuration+=tempDuration;
-            cout << sceneIndex << " changed to " << piMapper->getActivePresetIndex() << " for " << sceneDuration << endl;
+            // a scene that ended long ago (a stall, a clock step) starts its
+            // successor now instead of replaying every scene in between
+            int now = TimerWheel::instance()->now();
+            if (sceneDuration <= now) sceneDuration = now + tempDuration;
+            logNotice("{} changed to {} for {}", sceneIndex, piMapper->getActivePresetIndex(), sceneDuration);
+            sceneTimer = TimerWheel::instance()->scheduleAt(sceneDuration, [this](){ nextScene(); });
+        }
+    }
+}
+
+// Used by cluster followers to take over the leader's cue. endMillis is
+// the app time the scene ends at, like sceneDuration.
+void SceneManager::jumpToScene(int index, int endMillis){
+    TRACE_ZONE("SceneManager::jumpToScene");
+    if (index < 0 || index >= (int)result.size() || index == sceneIndex) return;
+    int targetPreset = result[index]["preset"].asInt();
+    if (targetPreset>=piMapper->getNumPresets()){
+        logError("cannot jump to scene {} as preset {} does not exist", index, targetPreset);
+        return;
+    }
+    TimerWheel::instance()->cancel(sceneTimer);
+    sceneIndex = index;
+    sceneDuration = endMillis;
+    piMapper->setPreset(targetPreset);
+    logNotice("{} jumped to {} for {}", sceneIndex, piMapper->getActivePresetIndex(), sceneDuration);
+    if (paused) {
+        // the clock starts once the timeline is resumed
+        pausedRemaining = MAX(0, endMillis - (int)TimerWheel::instance()->now());
+    }
+    else if (allowTransitions && result[index]["duration"].asInt() > 0) {
+        sceneTimer = TimerWheel::instance()->scheduleAt(sceneDuration, [this](){ nextScene(); });
+    }
+}
+
+// The wheel kept the scene timer's remaining time, the end follows it
+void SceneManager::rebase(int64_t delta){
+    if (!paused) sceneDuration += delta;
+}
+
+void SceneManager::applyCue(CueCommand & cue){
+    TRACE_ZONE("SceneManager::applyCue");
+    if (cue.type == CueCommand::GOTO_PRESET) {
+        if (cue.index < 0 || cue.index >= piMapper->getNumPresets()) {
+            logError("remote cue for preset {} which does not exist", cue.index);
+            return;
+        }
+        piMapper->setPreset(cue.index);
+        logNotice("Remote cue switched to preset: {}", piMapper->getActivePresetIndex());
+    }
+    else if (cue.type == CueCommand::GOTO_SCENE) {
+        if (cue.index < 0 || cue.index >= (int)result.size()) {
+            logError("remote cue for scene {} which does not exist", cue.index);
+            return;
         }
+        int duration = MAX(0, result[cue.index]["duration"].asInt());
+        jumpToScene(cue.index, TimerWheel::instance()->now() + duration);
+    }
+    else if (cue.type == CueCommand::PAUSE) {
+        pause();
+    }
+    else if (cue.type == CueCommand::RESUME) {
+        resume();
+    }
+    else if (cue.type == CueCommand::SET_PARAMETER) {
+        if (!parameterCallback || !parameterCallback(cue.source, cue.parameter, cue.value)) {
+            logError("remote cue for unknown parameter {}:{}", cue.source, cue.parameter);
+        }
+    }
+}
+
+void SceneManager::pause(){
+    if (paused) return;
+    paused = true;
+    TimerWheel::instance()->cancel(sceneTimer);
+    pausedRemaining = MAX(0, sceneDuration - (int)TimerWheel::instance()->now());
+    logNotice("scene timeline paused in scene {}, {}ms left", sceneIndex, pausedRemaining);
+}
+
+void SceneManager::resume(){
+    if (!paused) return;
+    paused = false;
+    sceneDuration = TimerWheel::instance()->now() + pausedRemaining;
+    if (allowTransitions) {
+        sceneTimer = TimerWheel::instance()->scheduleAt(sceneDuration, [this](){ nextScene(); });
+    }
+    logNotice("scene timeline resumed in scene {} for {}", sceneIndex, sceneDuration);
+}
+
+void SceneManager::setParameterCallback(std::function<bool(string, string, float)> callback){
+    parameterCallback = callback;
+}
+
+string SceneManager::getCueStatsString(){
+    stringstream ss;
+    ss << "remote cues: " << cueCount << " applied";
+    if (cueCount > 0) {
+        ss << ", latency last " << cueLatencyLast << "us, min " << cueLatencyMin
+           << "us, mean " << cueLatencySum / cueCount << "us, max " << cueLatencyMax << "us";
+    }
+    return ss.str();
+}
+
+// The scene and the time left in it. A preset picked by a remote cue is
+// kept too, it may differ from the scene's.
+void SceneManager::saveState(SnapshotWriter & out){
+    int32_t remaining = paused ? pausedRemaining : MAX(0, sceneDuration - (int)TimerWheel::instance()->now());
+    out.beginSection("SceneManager");
+    out.write((int32_t)sceneIndex);
+    out.write((int32_t)piMapper->getActivePresetIndex());
+    out.write(remaining);
+    out.write((uint8_t)paused);
+    out.endSection();
+}
+
+// Picks up where the last run stopped, measured against the scene file as
+// it is now
+bool SceneManager::restoreState(SnapshotReader & in){
+    int32_t index, preset, remaining;
+    uint8_t wasPaused;
+    if (!in.section("SceneManager") || !in.read(index) || !in.read(preset) || !in.read(remaining) || !in.read(wasPaused)) return false;
+    if (index < 0 || index >= (int)result.size() || preset < 0 || preset >= piMapper->getNumPresets()) {
+        logWarning("snapshot scene {} with preset {} does not exist any more, starting from scene {}", index, preset, sceneIndex);
+        return false;
+    }
+
+    TimerWheel::instance()->cancel(sceneTimer);
+    sceneIndex = index;
+    if (preset != piMapper->getActivePresetIndex()) piMapper->setPreset(preset);
+
+    int now = TimerWheel::instance()->now();
+    int duration = result[sceneIndex]["duration"].asInt();
+    allowTransitions = duration > 0;
+    remaining = MAX(0, MIN(remaining, duration));
+    sceneDuration = now + remaining;
+    paused = wasPaused;
+    if (paused) pausedRemaining = remaining;
+    else if (allowTransitions) {
+        sceneTimer = TimerWheel::instance()->scheduleAt(sceneDuration, [this](){ nextScene(); });
+    }
+    logNotice("resumed in scene {} with preset {}, {}ms left{}", sceneIndex, preset, remaining, paused ? ", paused" : "");
+    return true;
+}
+
+// Takes over an edited scene file and stays at the same position: same
+// scene index and the same time spent in it, measured against the scene's
+// new duration
+void SceneManager::reloadScenes(ofxJSONElement & scenes){
+    TRACE_ZONE("SceneManager::reloadScenes");
+    int now = TimerWheel::instance()->now();
+    int oldDuration = sceneIndex < (int)result.size() ? result[sceneIndex]["duration"].asInt() : 0;
+    int elapsed = 0;
+    if (paused) elapsed = oldDuration - pausedRemaining;
+    else if (allowTransitions) elapsed = now - (sceneDuration - oldDuration);
+    // with transitions off the scene had no clock, it starts over
+
+    result = scenes;
+    if (sceneIndex >= (int)result.size()) {
+        logWarning("scene {} was removed. Restarting from 0.", sceneIndex);
+        sceneIndex = 0;
+        elapsed = 0;
+    }
+
+    int targetPreset = result[sceneIndex]["preset"].asInt();
+    if (targetPreset != piMapper->getActivePresetIndex()) piMapper->setPreset(targetPreset);
+
+    TimerWheel::instance()->cancel(sceneTimer);
+    int duration = result[sceneIndex]["duration"].asInt();
+    if (duration <= 0) {
+        allowTransitions = false;
+        logNotice("scenes reloaded, {} scenes. scene duration set to <= 0, therefore transitions turned off.", result.size());
+        return;
+    }
+    allowTransitions = true;
+    elapsed = MAX(0, elapsed);
+    if (paused) {
+        pausedRemaining = MAX(0, duration - elapsed);
+        sceneDuration = now + pausedRemaining;
+    } else {
+        // a scene that is already past its new duration ends on the next tick
+        sceneDuration = now - elapsed + duration;
+        sceneTimer = TimerWheel::instance()->scheduleAt(sceneDuration, [this](){ nextScene(); });
     }
+    logNotice("scenes reloaded, {} scenes. still in scene {} for {}", result.size(), sceneIndex, sceneDuration);
 }
@@ -3,11 +3,37 @@
 #include "ofMain.h"
 #include "ofxJSON.h"
 #include "ofxPiMapper.h"
+#include "TimerWheel.h"
+#include "CueControl.h"
+#include "SceneFileWatcher.h"
+#include "AsyncLog.h"
+#include "Trace.h"
+#include "StateSnapshot.h"
+#include "InputLog.h"
+#include <functional>
 
 class SceneManager {
 	public:
         void setup(string scenesFile, ofxPiMapper *_piMapper);
         void update();
+        void nextScene();
+        void jumpToScene(int index, int endMillis);
+        // the clock was stepped by delta millis, see TimerWheel::rebase()
+        void rebase(int64_t delta);
+        void reloadScenes(ofxJSONElement & scenes);
+
+        // Remote cues, pushed by the CueControlServer thread
+        void applyCue(CueCommand & cue);
+        void pause();
+        void resume();
+        void setParameterCallback(std::function<bool(string, string, float)> callback);
+        string getCueStatsString();
+
+        // Position in the timeline, see StateSnapshot
+        void saveState(SnapshotWriter & out);
+        bool restoreState(SnapshotReader & in);
+        CueQueue cues;
+
         ofxJSONElement result;
         bool managePresets();
         ofxPiMapper *piMapper;
@@ -16,4 +42,13 @@ class SceneManager {
         int sceneDuration;
         int totalDuration;
         bool allowTransitions;
+        TimerWheel::TimerId sceneTimer;
+        SceneFileWatcher sceneWatcher;
+        bool paused;
+        int pausedRemaining;
+        std::function<bool(string, string, float)> parameterCallback;
+
+        // receive to apply latency of the remote cues, micros
+        int cueCount;
+        uint64_t cueLatencyLast, cueLatencyMin, cueLatencyMax, cueLatencySum;
 };
@@ -1,4 +1,6 @@
 #include "Settings.h"
+#include "ofxJSON.h"
+#include <cstdlib>
 
 Settings * Settings::_instance = 0;
 
@@ -11,6 +13,28 @@ Settings * Settings::instance(){
 
 Settings::Settings(){
     _fullscreen = false;
+    _clusterRole = "";
+    _clusterGroup = "239.255.42.99";
+    _clusterPort = 9742;
+    _clusterNodeId = "";
+    _clusterLog = "";
+    _cuePort = 0;
+    _attractFrameRate = 15;
+    _parameterSocket = "";
+    _benchFrames = 0;
+    _benchWarmupFrames = 60;
+    _benchOut = "render-benchmark.json";
+    _goldenDirectory = "";
+    _goldenRecord = false;
+    _goldenFrames = "30,120,300";
+    _snapshotPath = "";
+    _snapshotInterval = 10000;
+    _snapshotMaxAge = 600;
+    _recordInput = "";
+    _replayInput = "";
+    _replaySessions = 1;
+    _replaySpeed = 1;
+    _replayReport = "soak-report.csv";
 }
 
 void Settings::setFullscreen(bool f){
@@ -20,3 +44,316 @@ void Settings::setFullscreen(bool f){
 bool Settings::getFullscreen(){
     return _fullscreen;
 }
+
+void Settings::setClusterRole(string role){
+    _clusterRole = role;
+}
+
+string Settings::getClusterRole(){
+    return _clusterRole;
+}
+
+void Settings::setClusterGroup(string group){
+    _clusterGroup = group;
+}
+
+string Settings::getClusterGroup(){
+    return _clusterGroup;
+}
+
+void Settings::setClusterPort(int port){
+    _clusterPort = port;
+}
+
+int Settings::getClusterPort(){
+    return _clusterPort;
+}
+
+void Settings::setClusterNodeId(string nodeId){
+    _clusterNodeId = nodeId;
+}
+
+string Settings::getClusterNodeId(){
+    return _clusterNodeId;
+}
+
+void Settings::setClusterLog(string path){
+    _clusterLog = path;
+}
+
+string Settings::getClusterLog(){
+    return _clusterLog;
+}
+
+void Settings::setCuePort(int port){
+    _cuePort = port;
+}
+
+int Settings::getCuePort(){
+    return _cuePort;
+}
+
+void Settings::setAttractFrameRate(int fps){
+    _attractFrameRate = fps;
+}
+
+int Settings::getAttractFrameRate(){
+    return _attractFrameRate;
+}
+
+void Settings::setBenchFrames(int frames){
+    _benchFrames = frames;
+}
+
+int Settings::getBenchFrames(){
+    return _benchFrames;
+}
+
+void Settings::setBenchWarmupFrames(int frames){
+    _benchWarmupFrames = frames;
+}
+
+int Settings::getBenchWarmupFrames(){
+    return _benchWarmupFrames;
+}
+
+void Settings::setBenchOut(string path){
+    _benchOut = path;
+}
+
+string Settings::getBenchOut(){
+    return _benchOut;
+}
+
+void Settings::setGoldenDirectory(string path){
+    _goldenDirectory = path;
+}
+
+string Settings::getGoldenDirectory(){
+    return _goldenDirectory;
+}
+
+void Settings::setGoldenRecord(bool record){
+    _goldenRecord = record;
+}
+
+bool Settings::getGoldenRecord(){
+    return _goldenRecord;
+}
+
+void Settings::setGoldenFrames(string frames){
+    _goldenFrames = frames;
+}
+
+string Settings::getGoldenFrames(){
+    return _goldenFrames;
+}
+
+void Settings::setSnapshotPath(string path){
+    _snapshotPath = path;
+}
+
+string Settings::getSnapshotPath(){
+    return _snapshotPath;
+}
+
+void Settings::setSnapshotInterval(int millis){
+    _snapshotInterval = millis;
+}
+
+int Settings::getSnapshotInterval(){
+    return _snapshotInterval;
+}
+
+void Settings::setSnapshotMaxAge(int seconds){
+    _snapshotMaxAge = seconds;
+}
+
+int Settings::getSnapshotMaxAge(){
+    return _snapshotMaxAge;
+}
+
+void Settings::setRecordInput(string path){
+    _recordInput = path;
+}
+
+string Settings::getRecordInput(){
+    return _recordInput;
+}
+
+void Settings::setReplayInput(string path){
+    _replayInput = path;
+}
+
+string Settings::getReplayInput(){
+    return _replayInput;
+}
+
+void Settings::setReplaySessions(int sessions){
+    _replaySessions = sessions;
+}
+
+int Settings::getReplaySessions(){
+    return _replaySessions;
+}
+
+void Settings::setReplaySpeed(int speed){
+    _replaySpeed = speed;
+}
+
+int Settings::getReplaySpeed(){
+    return _replaySpeed;
+}
+
+void Settings::setReplayReport(string path){
+    _replayReport = path;
+}
+
+string Settings::getReplayReport(){
+    return _replayReport;
+}
+
+void Settings::setParameterSocket(string path){
+    _parameterSocket = path;
+}
+
+string Settings::getParameterSocket(){
+    return _parameterSocket;
+}
+
+//--------------------------------------------------------------
+// Runtime parameters
+
+void Settings::addParameter(string key, int * value, int min, int max, ChangeCallback onChange){
+    Parameter parameter;
+    parameter.type = Parameter::INT;
+    parameter.value = value;
+    parameter.min = min;
+    parameter.max = max;
+    parameter.onChange = onChange;
+    addParameter(key, parameter);
+}
+
+void Settings::addParameter(string key, float * value, float min, float max, ChangeCallback onChange){
+    Parameter parameter;
+    parameter.type = Parameter::FLOAT;
+    parameter.value = value;
+    parameter.min = min;
+    parameter.max = max;
+    parameter.onChange = onChange;
+    addParameter(key, parameter);
+}
+
+void Settings::addParameter(string key, bool * value, ChangeCallback onChange){
+    Parameter parameter;
+    parameter.type = Parameter::BOOL;
+    parameter.value = value;
+    parameter.min = 0;
+    parameter.max = 1;
+    parameter.onChange = onChange;
+    addParameter(key, parameter);
+}
+
+// The owner sets up with the value once registered, no onChange needed
+void Settings::addParameter(string key, Parameter parameter){
+    parameters[key] = parameter;
+    map<string, string>::iterator it = overrides.find(key);
+    if(it == overrides.end()) return;
+    string error;
+    if(!assign(parameters[key], it->second, error)) ofLogError("Settings") << key << ": " << error;
+}
+
+void Settings::removeParameters(string source){
+    string prefix = source + ":";
+    map<string, Parameter>::iterator it = parameters.lower_bound(prefix);
+    while(it != parameters.end() && it->first.compare(0, prefix.size(), prefix) == 0){
+        parameters.erase(it++);
+    }
+}
+
+bool Settings::setParameter(string key, string value, string & error){
+    map<string, Parameter>::iterator it = parameters.find(key);
+    if(it == parameters.end()){
+        error = "unknown parameter " + key;
+        return false;
+    }
+    string before = format(it->second);
+    if(!assign(it->second, value, error)) return false;
+    if(format(it->second) != before && it->second.onChange) it->second.onChange();
+    return true;
+}
+
+bool Settings::getParameter(string key, string & value){
+    map<string, Parameter>::iterator it = parameters.find(key);
+    if(it == parameters.end()) return false;
+    value = format(it->second);
+    return true;
+}
+
+string Settings::listParameters(){
+    stringstream out;
+    for(map<string, Parameter>::iterator it = parameters.begin(); it != parameters.end(); it++){
+        out << it->first << " = " << format(it->second);
+        if(it->second.type != Parameter::BOOL) out << " [" << it->second.min << ", " << it->second.max << "]";
+        out << endl;
+    }
+    return out.str();
+}
+
+void Settings::setParameterOverride(string key, string value){
+    overrides[key] = value;
+}
+
+// A flat object, { "Waterfall Game FBO Source:particles": 40, ... }
+bool Settings::loadParameters(string path){
+    ofxJSONElement file;
+    if(!ofFile::doesFileExist(path)) return false;
+    if(!file.open(path) || !file.isObject()){
+        ofLogError("Settings") << "could not parse " << path;
+        return false;
+    }
+    vector<string> keys = file.getMemberNames();
+    for(unsigned int i = 0; i < keys.size(); i++){
+        if(overrides.count(keys[i])) continue;
+        const Json::Value & value = file[keys[i]];
+        if(value.isBool()) overrides[keys[i]] = value.asBool() ? "1" : "0";
+        else if(value.isNumeric()) overrides[keys[i]] = ofToString(value.asDouble());
+        else if(value.isString()) overrides[keys[i]] = value.asString();
+        else ofLogError("Settings") << path << ": " << keys[i] << " is not a number";
+    }
+    ofLogNotice("Settings") << "loaded " << keys.size() << " parameters from " << path;
+    return true;
+}
+
+bool Settings::assign(Parameter & parameter, string text, string & error){
+    text = ofTrim(text);
+    if(parameter.type == Parameter::BOOL){
+        if(text == "1" || text == "true" || text == "on") *(bool *)parameter.value = true;
+        else if(text == "0" || text == "false" || text == "off") *(bool *)parameter.value = false;
+        else {
+            error = "expected true or false, got " + text;
+            return false;
+        }
+        return true;
+    }
+
+    char * end;
+    double number = strtod(text.c_str(), &end);
+    if(text.empty() || *end != 0){
+        error = "expected a number, got " + text;
+        return false;
+    }
+    if(number < parameter.min || number > parameter.max){
+        error = text + " is outside [" + ofToString(parameter.min) + ", " + ofToString(parameter.max) + "]";
+        return false;
+    }
+    if(parameter.type == Parameter::INT) *(int *)parameter.value = round(number);
+    else *(float *)parameter.value = number;
+    return true;
+}
+
+string Settings::format(Parameter & parameter){
+    if(parameter.type == Parameter::INT) return ofToString(*(int *)parameter.value);
+    if(parameter.type == Parameter::FLOAT) return ofToString(*(float *)parameter.value);
+    return *(bool *)parameter.value ? "true" : "false";
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include <functional>
 
 class Settings {
     public:
@@ -9,10 +10,140 @@ class Settings {
         void setFullscreen(bool f);
         bool getFullscreen();
 
+        // Cluster playback, see ClusterSync
+        void setClusterRole(string role);
+        string getClusterRole();
+        void setClusterGroup(string group);
+        string getClusterGroup();
+        void setClusterPort(int port);
+        int getClusterPort();
+        void setClusterNodeId(string nodeId);
+        string getClusterNodeId();
+        void setClusterLog(string path);
+        string getClusterLog();
+
+        // Remote cues, 0 turns the endpoint off
+        void setCuePort(int port);
+        int getCuePort();
+
+        // Render rate while the active preset shows nothing but game
+        // stations in attract mode
+        void setAttractFrameRate(int fps);
+        int getAttractFrameRate();
+
+        // Offscreen render benchmark, see RenderBenchmark. 0 frames is a normal run.
+        void setBenchFrames(int frames);
+        int getBenchFrames();
+        void setBenchWarmupFrames(int frames);
+        int getBenchWarmupFrames();
+        void setBenchOut(string path);
+        string getBenchOut();
+
+        // Golden image checks, see GoldenFrames. An empty directory is a normal run.
+        void setGoldenDirectory(string path);
+        string getGoldenDirectory();
+        void setGoldenRecord(bool record);
+        bool getGoldenRecord();
+        void setGoldenFrames(string frames);
+        string getGoldenFrames();
+
+        // State snapshots for a resume after a restart, see StateSnapshot.
+        // Off without a path, each instance needs a file of its own. An
+        // interval of 0 writes none, a maximum age of 0 never resumes.
+        void setSnapshotPath(string path);
+        string getSnapshotPath();
+        void setSnapshotInterval(int millis);
+        int getSnapshotInterval();
+        void setSnapshotMaxAge(int seconds);
+        int getSnapshotMaxAge();
+
+        // Input recording and replay, see InputLog and SoakTest. An empty
+        // path records or replays nothing, 0 sessions replay until stopped.
+        void setRecordInput(string path);
+        string getRecordInput();
+        void setReplayInput(string path);
+        string getReplayInput();
+        void setReplaySessions(int sessions);
+        int getReplaySessions();
+        void setReplaySpeed(int speed);
+        int getReplaySpeed();
+        void setReplayReport(string path);
+        string getReplayReport();
+
+        // Unix socket of the ParameterServer, empty turns it off
+        void setParameterSocket(string path);
+        string getParameterSocket();
+
+        // Runtime parameters
+        //
+        // Sources register the values that decide their load, bound to
+        // their own variables, under "<source name>:<parameter>". Values
+        // come from settings.json, then --set on the command line, and can
+        // be changed while running (ParameterServer, remote cues). The
+        // owner is told through onChange and resizes its pools or grids.
+        // Everything here runs on the main thread.
+        typedef std::function<void()> ChangeCallback;
+
+        void addParameter(string key, int * value, int min, int max, ChangeCallback onChange = ChangeCallback());
+        void addParameter(string key, float * value, float min, float max, ChangeCallback onChange = ChangeCallback());
+        void addParameter(string key, bool * value, ChangeCallback onChange = ChangeCallback());
+        // forgets every parameter of a source, before it goes away
+        void removeParameters(string source);
+
+        bool setParameter(string key, string value, string & error);
+        bool getParameter(string key, string & value);
+        string listParameters();
+
+        // values for parameters that are registered later, the command
+        // line ones win over the file
+        void setParameterOverride(string key, string value);
+        bool loadParameters(string path);
+
     private:
+        struct Parameter {
+            enum Type {
+                INT,
+                FLOAT,
+                BOOL
+            };
+            Type type;
+            void * value;
+            float min, max;
+            ChangeCallback onChange;
+        };
+
+        void addParameter(string key, Parameter parameter);
+        bool assign(Parameter & parameter, string text, string & error);
+        string format(Parameter & parameter);
+
+        map<string, Parameter> parameters;
+        map<string, string> overrides;
+
         static Settings * _instance;
 
         Settings();
 
         bool _fullscreen;
+        string _clusterRole;
+        string _clusterGroup;
+        int _clusterPort;
+        string _clusterNodeId;
+        string _clusterLog;
+        int _cuePort;
+        int _attractFrameRate;
+        string _parameterSocket;
+        int _benchFrames;
+        int _benchWarmupFrames;
+        string _benchOut;
+        string _goldenDirectory;
+        bool _goldenRecord;
+        string _goldenFrames;
+        string _snapshotPath;
+        int _snapshotInterval;
+        int _snapshotMaxAge;
+        string _recordInput;
+        string _replayInput;
+        int _replaySessions;
+        int _replaySpeed;
+        string _replayReport;
 };
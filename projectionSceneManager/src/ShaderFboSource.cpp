@@ -0,0 +1,138 @@
+#include "ShaderFboSource.h"
+#include <sys/stat.h>
+
+// Vertex stage shared by all shader sources, one for each renderer flavour
+static string vertexSourceProgrammable =
+    "attribute vec4 position;\n"
+    "uniform mat4 modelViewProjectionMatrix;\n"
+    "uniform vec2 resolution;\n"
+    "varying vec2 uv;\n"
+    "void main(){\n"
+    "    uv = position.xy / resolution;\n"
+    "    gl_Position = modelViewProjectionMatrix * position;\n"
+    "}\n";
+
+static string vertexSourceFixed =
+    "#version 120\n"
+    "uniform vec2 resolution;\n"
+    "varying vec2 uv;\n"
+    "void main(){\n"
+    "    uv = gl_Vertex.xy / resolution;\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+    "}\n";
+
+//--------------------------------------------------------------
+ShaderFileWatcher::ShaderFileWatcher(){
+    lastModified = 0;
+    hasPending = false;
+}
+
+void ShaderFileWatcher::watch(string _path){
+    path = ofToDataPath(_path, true);
+    readIfChanged();
+    startThread();
+}
+
+bool ShaderFileWatcher::fetchChanged(string & source){
+    lock();
+    bool changed = hasPending;
+    if(changed){
+        source.swap(pendingSource);
+        hasPending = false;
+    }
+    unlock();
+    return changed;
+}
+
+void ShaderFileWatcher::threadedFunction(){
+    while(isThreadRunning()){
+        readIfChanged();
+        sleep(500);
+    }
+}
+
+// File I/O stays off the render thread, only the compile happens there
+bool ShaderFileWatcher::readIfChanged(){
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0 || info.st_mtime == lastModified) return false;
+    lastModified = info.st_mtime;
+
+    ifstream in(path.c_str());
+    stringstream ss;
+    ss << in.rdbuf();
+
+    lock();
+    pendingSource = ss.str();
+    hasPending = true;
+    unlock();
+    return true;
+}
+
+//--------------------------------------------------------------
+ShaderFboSource::ShaderFboSource(){
+    time = 0;
+}
+
+ShaderFboSource::~ShaderFboSource(){
+    watcher.waitForThread(true);
+}
+
+void ShaderFboSource::setShader(string fragPath){
+    shaderPath = fragPath;
+    watcher.watch(fragPath);
+
+    // compile right away so the first frame is not missing
+    string source;
+    if(watcher.fetchChanged(source)) compile(source);
+}
+
+void ShaderFboSource::exit(){
+    watcher.waitForThread(true);
+}
+
+// Don't do any drawing here
+void ShaderFboSource::update(){
+    TRACE_ZONE("ShaderFboSource::update");
+    string source;
+    if(watcher.fetchChanged(source)){
+        if(compile(source)) ofLogNotice("ShaderFboSource") << name << ": reloaded " << shaderPath;
+    }
+}
+
+// No need to take care of fbo.begin() and fbo.end() here.
+// All within draw() is being rendered into fbo;
+void ShaderFboSource::draw(){
+    TRACE_ZONE("ShaderFboSource::draw");
+    DrawStatsScope drawStats(name);
+    ofClear(0);
+    if(!shader.isLoaded()) return;
+
+    shader.begin();
+    shader.setUniform1f("time", time);
+    shader.setUniform2f("resolution", fbo->getWidth(), fbo->getHeight());
+    setUniforms(shader);
+    counted::ofDrawRectangle(0, 0, fbo->getWidth(), fbo->getHeight());
+    shader.end();
+}
+
+bool ShaderFboSource::compile(string fragSource){
+    bool programmable = ofIsGLProgrammableRenderer();
+    string header = programmable
+        ? "#ifdef GL_ES\nprecision mediump float;\n#endif\nvarying vec2 uv;\n"
+        : "#version 120\nvarying vec2 uv;\n";
+
+    // build into a fresh shader so a broken edit never replaces a working one
+    ofShader next;
+    if(!next.setupShaderFromSource(GL_VERTEX_SHADER, programmable ? vertexSourceProgrammable : vertexSourceFixed)
+       || !next.setupShaderFromSource(GL_FRAGMENT_SHADER, header + fragSource)){
+        ofLogError("ShaderFboSource") << name << ": " << shaderPath << " failed to compile, keeping the previous shader";
+        return false;
+    }
+    if(programmable) next.bindDefaults();
+    if(!next.linkProgram()){
+        ofLogError("ShaderFboSource") << name << ": " << shaderPath << " failed to link, keeping the previous shader";
+        return false;
+    }
+    shader = next;
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FboSource.h"
+#include "Trace.h"
+#include "DrawStats.h"
+
+// Watches a fragment shader file from a background thread and hands its
+// source over to the render thread whenever it changes on disk.
+class ShaderFileWatcher : public ofThread {
+    public:
+        ShaderFileWatcher();
+
+        void watch(string _path);
+        bool fetchChanged(string & source);
+
+    private:
+        void threadedFunction();
+        bool readIfChanged();
+
+        string path;
+        time_t lastModified;
+        string pendingSource;
+        bool hasPending;
+};
+
+// Base class for procedural sources that are drawn by a fragment shader over
+// the whole FBO. Derived classes pick a shader in setup() and pass their own
+// parameters in setUniforms(). Every shader gets:
+//   uniform float time;       // seconds, or whatever update() puts in `time`
+//   uniform vec2 resolution;  // FBO size in pixels
+//   varying vec2 uv;          // 0..1, top-left origin of the source
+// The shader is compiled once and recompiled only after its file changed.
+// A shader that fails to compile leaves the previous one in place.
+class ShaderFboSource : public ofx::piMapper::FboSource {
+    public:
+        ShaderFboSource();
+        virtual ~ShaderFboSource();
+
+        void setShader(string fragPath);
+        virtual void update();
+        virtual void draw();
+        virtual void exit();
+        virtual void setUniforms(ofShader &){}
+
+        float time;
+
+    protected:
+        bool compile(string fragSource);
+
+        ofShader shader;
+        ShaderFileWatcher watcher;
+        string shaderPath;
+};
@@ -0,0 +1,125 @@
+#include "SoakTest.h"
+#include "TimerWheel.h"
+#include "AsyncLog.h"
+#include <unistd.h>
+
+// times must be sorted
+static float percentile(const vector<float> & times, float p){
+    if(times.empty()) return 0;
+    int index = MIN((int)times.size() - 1, (int)(p * times.size()));
+    return times[index];
+}
+
+SoakTest::SoakTest(){
+    game = 0;
+    cues = 0;
+    running = false;
+    sessions = 0;
+    speed = 1;
+    startMillis = 0;
+    stepCount = 0;
+    session = 0;
+    sessionStart = 0;
+    frameStart = 0;
+    firstResident = 0;
+}
+
+void SoakTest::setup(WaterfallGameSource * _game, CueQueue * _cues, int _sessions, int _speed,
+                     string _reportPath, uint64_t _startMillis){
+    game = _game;
+    cues = _cues;
+    sessions = _sessions;
+    speed = MAX(1, _speed);
+    reportPath = _reportPath;
+    startMillis = _startMillis;
+    stepCount = 0;
+    session = 0;
+
+    InputLog * input = InputLog::instance();
+    if(!input->isReplaying() || input->getLength() == 0){
+        logError("soak test: nothing to replay");
+        ofExit(1);
+        return;
+    }
+    report.open(reportPath.c_str());
+    if(!report.is_open()){
+        logError("soak test: could not write {}", reportPath);
+        ofExit(1);
+        return;
+    }
+    report << "session,simulatedSeconds,frames,meanMillis,p99Millis,maxMillis,residentMB,pendingTimers,caught" << endl;
+    firstResident = residentBytes();
+    running = true;
+    logNotice("soak test: {} sessions of {}s at {}x, report in {}", sessions, input->getLength() / 1000.0, speed, reportPath);
+    startSession();
+}
+
+bool SoakTest::isRunning(){
+    return running;
+}
+
+int SoakTest::getSpeed(){
+    return running ? speed : 1;
+}
+
+uint64_t SoakTest::now(){
+    return startMillis + stepCount * 1000 / 60;
+}
+
+void SoakTest::step(){
+    if(!running) return;
+    stepCount++;
+    if(!InputLog::instance()->apply(now(), *cues)){
+        endSession();
+        if(sessions > 0 && session >= sessions){
+            running = false;
+            logNotice("soak test: done, resident memory {}MB at the start, {}MB now",
+                      firstResident / (1024 * 1024), residentBytes() / (1024 * 1024));
+            report.close();
+            ofExit(0);
+            return;
+        }
+        startSession();
+    }
+}
+
+// every session starts the recording and the game over, the particles
+// and the scene timeline carry on
+void SoakTest::startSession(){
+    session++;
+    sessionStart = now();
+    frameMillis.clear();
+    InputLog::instance()->restart(sessionStart);
+    game->gameReset();
+}
+
+void SoakTest::endSession(){
+    vector<float> & times = frameMillis;
+    double sum = 0;
+    for(unsigned int i = 0; i < times.size(); i++) sum += times[i];
+    double mean = times.empty() ? 0 : sum / times.size();
+    sort(times.begin(), times.end());
+    float resident = residentBytes() / (1024.0f * 1024.0f);
+
+    report << session << "," << (now() - sessionStart) / 1000.0 << "," << times.size() << ","
+           << mean << "," << percentile(times, 0.99) << "," << (times.empty() ? 0 : times.back()) << ","
+           << resident << "," << TimerWheel::instance()->getNumPending() << "," << game->caughtCount << endl;
+    logNotice("soak test: session {}, mean {}ms, p99 {}ms, {}MB resident", session, mean, percentile(times, 0.99), resident);
+}
+
+void SoakTest::beginFrame(){
+    frameStart = ofGetElapsedTimeMicros();
+}
+
+void SoakTest::endFrame(){
+    if(!running) return;
+    frameMillis.push_back((ofGetElapsedTimeMicros() - frameStart) / 1000.0f);
+}
+
+// from /proc, the second field is the resident set in pages
+uint64_t SoakTest::residentBytes(){
+    ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ofMain.h"
+#include "InputLog.h"
+#include "WaterfallGameSource.h"
+
+// Replays a recorded show, session after session, to soak test memory
+// and frame times over days of simulated play.
+//
+//   xvfb-run -a bin/projectionSceneManager --replay-input input.tsv --replay-sessions 500 --replay-speed 8
+//
+// Random numbers are seeded and the clock advances a fixed 1/60 s per
+// simulation step, the buttons and cues come from the InputLog. Each
+// session plays the whole recording, starting with a new game. With a speed
+// above 1 every drawn frame simulates that many steps, the extra ones
+// update the sources without drawing them, so a day of play takes a day
+// divided by the speed if the machine keeps up.
+//
+// After every session a line goes to the report CSV (frame times of the
+// update and draw, resident memory, pending timers), so a run that is
+// stopped or crashes still leaves its numbers. 0 sessions runs until
+// stopped. The app quits after the last one.
+class SoakTest {
+    public:
+        SoakTest();
+
+        static const int seed = 4321;
+
+        void setup(WaterfallGameSource * _game, CueQueue * _cues, int _sessions, int _speed,
+                   string _reportPath, uint64_t _startMillis);
+        bool isRunning();
+
+        // simulation steps per drawn frame
+        int getSpeed();
+        // the fixed clock, millis
+        uint64_t now();
+        // one 1/60 s step: the clock, then the inputs due by then
+        void step();
+
+        // start of ofApp::update() and end of ofApp::draw()
+        void beginFrame();
+        void endFrame();
+
+    private:
+        void startSession();
+        void endSession();
+        static uint64_t residentBytes();
+
+        WaterfallGameSource * game;
+        CueQueue * cues;
+        bool running;
+        int sessions;
+        int speed;
+        string reportPath;
+        ofstream report;
+
+        uint64_t startMillis;
+        uint64_t stepCount;
+        int session;
+        uint64_t sessionStart;
+        uint64_t frameStart;
+        vector<float> frameMillis;
+        uint64_t firstResident;
+};
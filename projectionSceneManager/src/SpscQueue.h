@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Neither side ever waits: push() fails when the queue is full and
+// pop() when it is empty. Capacity is rounded up to a power of two.
+template<typename T>
+class SpscQueue {
+    public:
+        SpscQueue(unsigned int capacity = 256){
+            unsigned int size = 1;
+            while(size < capacity) size <<= 1;
+            items.resize(size);
+            mask = size - 1;
+            head = 0;
+            tail = 0;
+        }
+
+        // producer side
+        bool push(const T & item){
+            unsigned int t = tail.load(std::memory_order_relaxed);
+            if(t - head.load(std::memory_order_acquire) > mask) return false;
+            items[t & mask] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side
+        bool pop(T & item){
+            unsigned int h = head.load(std::memory_order_relaxed);
+            if(h == tail.load(std::memory_order_acquire)) return false;
+            item = items[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        unsigned int size(){
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+    private:
+        // a cache line of padding around each index, so the two threads
+        // don't share one. Padding rather than alignas(64): that alignment
+        // is not honoured by new before C++17 and makes -Wall warn in every
+        // class that holds a queue.
+        static const int cacheLine = 64;
+
+        std::vector<T> items;
+        unsigned int mask;
+        char padHead[cacheLine];
+        std::atomic<unsigned int> head;
+        char padTail[cacheLine - sizeof(std::atomic<unsigned int>)];
+        std::atomic<unsigned int> tail;
+        char padEnd[cacheLine - sizeof(std::atomic<unsigned int>)];
+};
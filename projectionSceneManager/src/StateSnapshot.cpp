@@ -0,0 +1,221 @@
+#include "StateSnapshot.h"
+#include "AsyncLog.h"
+#include <cstdio>
+#include <unistd.h>
+#include <sys/time.h>
+
+static const uint32_t snapshotMagic = 0x4e53534d; // "MSSN"
+// bump whenever a section changes its layout
+static const uint16_t snapshotVersion = 1;
+
+//--------------------------------------------------------------
+void SnapshotWriter::clear(size_t reserved){
+    data.assign(reserved, 0);
+    sectionStart = 0;
+}
+
+// name length, name, payload length (filled in by endSection), payload
+void SnapshotWriter::beginSection(const string & name){
+    write((uint16_t)name.size());
+    append(name.data(), name.size());
+    sectionStart = data.size();
+    write((uint32_t)0);
+}
+
+void SnapshotWriter::endSection(){
+    uint32_t length = data.size() - sectionStart - sizeof(uint32_t);
+    memcpy(&data[sectionStart], &length, sizeof(length));
+}
+
+void SnapshotWriter::append(const void * bytes, size_t length){
+    const char * b = (const char *)bytes;
+    data.insert(data.end(), b, b + length);
+}
+
+//--------------------------------------------------------------
+SnapshotReader::SnapshotReader(){
+    savedAt = 0;
+    data = 0;
+    pos = end = 0;
+}
+
+bool SnapshotReader::open(const char * bytes, size_t length){
+    sections.clear();
+    data = bytes;
+    pos = 0;
+    end = length;
+    while(pos < length){
+        uint16_t nameLength;
+        if(!read(nameLength) || pos + nameLength > length) return false;
+        string name(data + pos, nameLength);
+        pos += nameLength;
+        uint32_t sectionLength;
+        if(!read(sectionLength) || pos + sectionLength > length) return false;
+        sections[name] = make_pair(pos, pos + sectionLength);
+        pos += sectionLength;
+    }
+    pos = end = 0;
+    return true;
+}
+
+bool SnapshotReader::section(const string & name){
+    map<string, pair<size_t, size_t> >::iterator it = sections.find(name);
+    if(it == sections.end()) return false;
+    pos = it->second.first;
+    end = it->second.second;
+    return true;
+}
+
+//--------------------------------------------------------------
+StateSnapshot::StateSnapshot(){
+    back = 0;
+    writing = false;
+    captureStart = 0;
+    captured = skipped = 0;
+    written = failed = 0;
+    captureMicros = 0;
+    writeMicros = 0;
+}
+
+StateSnapshot::~StateSnapshot(){
+    close();
+}
+
+void StateSnapshot::setup(string _path){
+    path = ofToDataPath(_path, true);
+    startThread();
+}
+
+// a write that is going on is finished first
+void StateSnapshot::close(){
+    if(isThreadRunning()) waitForThread(true);
+}
+
+SnapshotWriter & StateSnapshot::begin(){
+    captureStart = ofGetElapsedTimeMicros();
+    SnapshotWriter & buffer = buffers[back];
+    buffer.clear(sizeof(Header));
+    return buffer;
+}
+
+void StateSnapshot::commit(){
+    if(writing.load(std::memory_order_acquire)){
+        skipped++;
+        return;
+    }
+    SnapshotWriter & buffer = buffers[back];
+    int64_t savedAt = wallMillis();
+    memcpy(&buffer.data[offsetof(Header, savedAt)], &savedAt, sizeof(savedAt));
+    back ^= 1;
+    writing.store(true, std::memory_order_release);
+    captured++;
+    captureMicros = ofGetElapsedTimeMicros() - captureStart;
+}
+
+void StateSnapshot::threadedFunction(){
+    while(isThreadRunning()){
+        if(!writing.load(std::memory_order_acquire)){
+            sleep(10);
+            continue;
+        }
+        uint64_t start = ofGetElapsedTimeMicros();
+        if(write(buffers[back ^ 1])) written++;
+        else failed++;
+        writeMicros = ofGetElapsedTimeMicros() - start;
+        writing.store(false, std::memory_order_release);
+    }
+}
+
+// The rename replaces the last snapshot in one step, after the data is on disk
+bool StateSnapshot::write(SnapshotWriter & buffer){
+    Header header;
+    memcpy(&header, buffer.data.data(), sizeof(header));
+    header.magic = snapshotMagic;
+    header.version = snapshotVersion;
+    header.headerSize = sizeof(Header);
+    header.payloadSize = buffer.data.size() - sizeof(Header);
+    header.checksum = checksum(buffer.data.data() + sizeof(Header), header.payloadSize);
+    memcpy(buffer.data.data(), &header, sizeof(header));
+
+    string temporary = path + ".tmp";
+    FILE * file = fopen(temporary.c_str(), "wb");
+    if(file == 0){
+        logError("snapshot: could not write {}", temporary);
+        return false;
+    }
+    bool ok = fwrite(buffer.data.data(), 1, buffer.data.size(), file) == buffer.data.size();
+    ok = fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+    if(!ok || rename(temporary.c_str(), path.c_str()) != 0){
+        logError("snapshot: could not write {}", path);
+        return false;
+    }
+    return true;
+}
+
+bool StateSnapshot::load(string _path, uint64_t maxAgeMillis, SnapshotReader & reader){
+    string file = ofToDataPath(_path, true);
+    ofBuffer contents = ofBufferFromFile(file, true);
+    if(contents.size() == 0){
+        logNotice("snapshot: none at {}, cold start", file);
+        return false;
+    }
+
+    Header header;
+    if(contents.size() < sizeof(Header)){
+        logWarning("snapshot: {} is truncated, cold start", file);
+        return false;
+    }
+    memcpy(&header, contents.getData(), sizeof(header));
+    if(header.magic != snapshotMagic || header.version != snapshotVersion || header.headerSize != sizeof(Header)){
+        logWarning("snapshot: {} is from another version, cold start", file);
+        return false;
+    }
+    const char * payload = contents.getData() + sizeof(Header);
+    if(header.payloadSize != contents.size() - sizeof(Header) || header.checksum != checksum(payload, header.payloadSize)){
+        logWarning("snapshot: {} is damaged, cold start", file);
+        return false;
+    }
+    int64_t age = wallMillis() - header.savedAt;
+    if(age < 0 || (uint64_t)age > maxAgeMillis){
+        logNotice("snapshot: {} is {}s old, cold start", file, age / 1000);
+        return false;
+    }
+
+    // the reader keeps its own copy, the sections point into it
+    vector<char> & buffer = reader.buffer;
+    buffer.assign(payload, payload + header.payloadSize);
+    if(!reader.open(buffer.data(), buffer.size())){
+        logWarning("snapshot: {} has broken sections, cold start", file);
+        return false;
+    }
+    reader.savedAt = header.savedAt;
+    logNotice("snapshot: resuming from {}, {}s old", file, age / 1000.0);
+    return true;
+}
+
+string StateSnapshot::getStatsString(){
+    stringstream ss;
+    ss << "snapshots: " << captured << " captured, " << written << " written";
+    if(skipped > 0) ss << ", " << skipped << " skipped while writing";
+    if(failed > 0) ss << ", " << failed << " failed";
+    ss << ", last capture " << captureMicros << "us, last write " << writeMicros << "us";
+    return ss.str();
+}
+
+// FNV-1a, enough to tell a torn or damaged file
+uint32_t StateSnapshot::checksum(const char * bytes, size_t length){
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < length; i++){
+        hash ^= (uint8_t)bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int64_t StateSnapshot::wallMillis(){
+    struct timeval now;
+    gettimeofday(&now, 0);
+    return (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
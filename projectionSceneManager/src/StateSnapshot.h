@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+
+// Sequential writer of one snapshot. Each owner of state writes a section
+// under its own name. Values are copied as raw bytes, so only plain
+// structs (ints, floats, ofVec2f, ofPoint, ofColor) go in.
+class SnapshotWriter {
+    public:
+        void clear(size_t reserved);
+        void beginSection(const string & name);
+        void endSection();
+
+        template<typename T>
+        void write(const T & value){
+            append(&value, sizeof(T));
+        }
+
+        // count elements, stored with their size so a changed struct is
+        // noticed on reading
+        template<typename T>
+        void writeArray(const T * values, int count){
+            write((uint32_t)count);
+            write((uint32_t)sizeof(T));
+            append(values, sizeof(T) * count);
+        }
+
+        void append(const void * bytes, size_t length);
+
+        vector<char> data;
+
+    private:
+        size_t sectionStart;
+};
+
+// Reads the sections of a snapshot back, in any order. Every read fails
+// rather than running past the end of its section.
+class SnapshotReader {
+    public:
+        SnapshotReader();
+
+        bool open(const char * bytes, size_t length);
+        // moves to the named section, false when the snapshot has none
+        bool section(const string & name);
+
+        template<typename T>
+        bool read(T & value){
+            if(pos + sizeof(T) > end) return false;
+            memcpy(&value, data + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+
+        template<typename T>
+        bool readArray(vector<T> & values){
+            uint32_t count, size;
+            if(!read(count) || !read(size)) return false;
+            if(size != sizeof(T) || pos + (size_t)count * size > end) return false;
+            values.resize(count);
+            if(count > 0) memcpy(values.data(), data + pos, (size_t)count * size);
+            pos += (size_t)count * size;
+            return true;
+        }
+
+        // wall clock time of the capture, millis since the epoch
+        int64_t savedAt;
+
+    private:
+        friend class StateSnapshot;
+
+        vector<char> buffer;
+        const char * data;
+        size_t pos, end;
+        map<string, pair<size_t, size_t> > sections;
+};
+
+// The show state in a small binary file, for an instant resume after a
+// crash or a watchdog restart.
+//
+// Every interval the app has the scene manager and the game stations write
+// their state into begin(): a few hundred bytes of counters and timer
+// remainders and the particle arrays, copied in well under a millisecond.
+// commit() hands that buffer to a background thread and the main thread
+// goes on with the other one. The thread writes a temporary file, syncs it
+// and renames it over the last snapshot, so a crash while writing leaves
+// the previous snapshot in place. A capture while the last write is still
+// going is skipped, the main thread never waits for the disk.
+//
+// On start load() reads the file back. A snapshot that is damaged, from
+// another build or older than the maximum age is ignored and the show
+// starts cold. Times are stored as the remainders of the running timers,
+// the owners schedule them again on the new clock.
+class StateSnapshot : public ofThread {
+    public:
+        StateSnapshot();
+        ~StateSnapshot();
+
+        void setup(string _path);
+        void close();
+
+        SnapshotWriter & begin();
+        void commit();
+
+        bool load(string _path, uint64_t maxAgeMillis, SnapshotReader & reader);
+
+        string getStatsString();
+
+    private:
+        struct Header {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t headerSize;
+            uint32_t payloadSize;
+            uint32_t checksum;
+            int64_t savedAt;
+        };
+
+        void threadedFunction();
+        bool write(SnapshotWriter & buffer);
+
+        static uint32_t checksum(const char * bytes, size_t length);
+        static int64_t wallMillis();
+
+        string path;
+
+        // the main thread fills buffers[back], the thread writes the other
+        // one while writing is set
+        SnapshotWriter buffers[2];
+        int back;
+        std::atomic<bool> writing;
+        uint64_t captureStart;
+
+        int captured, skipped;
+        std::atomic<int> written, failed;
+        uint64_t captureMicros;
+        std::atomic<uint64_t> writeMicros;
+};
@@ -0,0 +1,91 @@
+#include "SurfaceBatcher.h"
+
+SurfaceBatcher::SurfaceBatcher(){
+    numSurfaces = 0;
+    dirty = true;
+}
+
+void SurfaceBatcher::setTexture(string sourceName, ofTexture * texture, ofRectangle region){
+    SourceTexture & t = textures[sourceName];
+    t.texture = texture;
+    t.region = region;
+    t.clamped = false;
+    dirty = true;
+}
+
+void SurfaceBatcher::setTexture(string sourceName, ofTexture * texture, ofRectangle region, ofRectangle clampTo){
+    setTexture(sourceName, texture, region);
+    textures[sourceName].clamped = true;
+    textures[sourceName].clampTo = clampTo;
+}
+
+void SurfaceBatcher::setTexture(string sourceName, ofTexture * texture){
+    // the far corner tells whether the texture uses pixel (ARB) or normalized coordinates
+    ofVec2f corner = texture->getCoordFromPercent(1, 1);
+    setTexture(sourceName, texture, ofRectangle(0, 0, corner.x, corner.y));
+}
+
+void SurfaceBatcher::clearTextures(){
+    textures.clear();
+    dirty = true;
+}
+
+bool SurfaceBatcher::canDraw(vector<SurfaceDef> & surfaces){
+    for(unsigned int i = 0; i < surfaces.size(); i++){
+        if(textures.find(surfaces[i].sourceName) == textures.end()) return false;
+    }
+    return true;
+}
+
+void SurfaceBatcher::build(vector<SurfaceDef> & surfaces){
+    batches.clear();
+    numSurfaces = 0;
+
+    for(unsigned int i = 0; i < surfaces.size(); i++){
+        map<string, SourceTexture>::iterator it = textures.find(surfaces[i].sourceName);
+        if(it == textures.end()) continue;
+
+        Batch * batch = NULL;
+        for(unsigned int b = 0; b < batches.size(); b++){
+            if(batches[b].texture == it->second.texture){
+                batch = &batches[b];
+                break;
+            }
+        }
+        if(batch == NULL){
+            batches.push_back(Batch());
+            batch = &batches.back();
+            batch->texture = it->second.texture;
+            batch->mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+            batch->mesh.setUsage(GL_STATIC_DRAW);
+        }
+        SourceTexture & t = it->second;
+        SurfaceLayout::addSurfaceToMesh(surfaces[i], batch->mesh, t.region, t.clamped ? &t.clampTo : NULL);
+        numSurfaces++;
+    }
+    dirty = false;
+}
+
+void SurfaceBatcher::draw(){
+    for(unsigned int b = 0; b < batches.size(); b++){
+        batches[b].texture->bind();
+        counted::draw(batches[b].mesh);
+        batches[b].texture->unbind();
+    }
+}
+
+void SurfaceBatcher::markDirty(){
+    dirty = true;
+}
+
+bool SurfaceBatcher::isDirty(){
+    return dirty;
+}
+
+int SurfaceBatcher::getNumBatches(){
+    return batches.size();
+}
+
+int SurfaceBatcher::getNumSurfaces(){
+    return numSurfaces;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SurfaceLayout.h"
+#include "DrawStats.h"
+
+// Merges the warped geometry of all surfaces that sample the same texture
+// into one static VBO, so a preset costs one draw call per texture instead
+// of one per surface. Batches are only rebuilt when marked dirty.
+//
+// Note that batching changes the stacking order between surfaces of
+// different textures: batches are drawn in order of first appearance.
+//
+// A preset is only batched when every surface's texture was set. The app
+// sets those of its FBO sources and of the image sources, which it loads
+// again itself. piMapper does not hand out the textures of its video
+// sources, so a preset showing one of them is drawn by piMapper. To batch
+// surfaces cut from a video, play it as a CachedVideoSource instead.
+class SurfaceBatcher {
+    public:
+        SurfaceBatcher();
+
+        // region is in the texture's own coordinates, (0, 0, w, h) for ARB
+        // textures and (0, 0, 1, 1) for normalized ones unless it is an atlas
+        void setTexture(string sourceName, ofTexture * texture, ofRectangle region);
+        void setTexture(string sourceName, ofTexture * texture);
+        // for textures shared with other sources: the sampled coordinates
+        // are kept inside clampTo so nothing bleeds in from the neighbours
+        void setTexture(string sourceName, ofTexture * texture, ofRectangle region, ofRectangle clampTo);
+        void clearTextures();
+
+        bool canDraw(vector<SurfaceDef> & surfaces);
+        void build(vector<SurfaceDef> & surfaces);
+        void draw();
+
+        void markDirty();
+        bool isDirty();
+
+        int getNumBatches();
+        int getNumSurfaces();
+
+    private:
+        struct SourceTexture {
+            ofTexture * texture;
+            ofRectangle region;
+            bool clamped;
+            ofRectangle clampTo;
+        };
+        struct Batch {
+            ofTexture * texture;
+            ofVboMesh mesh;
+        };
+
+        map<string, SourceTexture> textures;
+        vector<Batch> batches;
+        int numSurfaces;
+        bool dirty;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ofMain.h"
+
+// Surface types as stored by piMapper in ofxpimapper.xml
+#define SURFACE_TYPE_TRIANGLE 0
+#define SURFACE_TYPE_QUAD 1
+
+struct SurfaceDef {
+    int type;
+    vector<ofVec2f> vertices;
+    vector<ofVec2f> texCoords;
+    string sourceType;
+    string sourceName;
+    bool perspectiveWarping;
+};
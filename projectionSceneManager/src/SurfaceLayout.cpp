@@ -0,0 +1,131 @@
+#include "SurfaceLayout.h"
+
+bool SurfaceLayout::load(string xmlFile){
+    fileName = xmlFile;
+    presets.clear();
+
+    ofxXmlSettings xml;
+    if(!xml.load(xmlFile)){
+        ofLogError("SurfaceLayout") << "could not load " << xmlFile;
+        return false;
+    }
+
+    // every <surfaces> root element is one preset
+    int numPresets = xml.getNumTags("surfaces");
+    for(int p = 0; p < numPresets; p++){
+        presets.push_back(vector<SurfaceDef>());
+        xml.pushTag("surfaces", p);
+
+        int numSurfaces = xml.getNumTags("surface");
+        for(int s = 0; s < numSurfaces; s++){
+            SurfaceDef surface;
+            surface.type = xml.getAttribute("surface", "type", SURFACE_TYPE_QUAD, s);
+            xml.pushTag("surface", s);
+
+            xml.pushTag("vertices");
+            for(int v = 0; v < xml.getNumTags("vertex"); v++){
+                xml.pushTag("vertex", v);
+                surface.vertices.push_back(ofVec2f(xml.getValue("x", 0.0), xml.getValue("y", 0.0)));
+                xml.popTag();
+            }
+            xml.popTag();
+
+            xml.pushTag("texCoords");
+            for(int t = 0; t < xml.getNumTags("texCoord"); t++){
+                xml.pushTag("texCoord", t);
+                surface.texCoords.push_back(ofVec2f(xml.getValue("x", 0.0), xml.getValue("y", 0.0)));
+                xml.popTag();
+            }
+            xml.popTag();
+
+            surface.sourceType = xml.getValue("source:source-type", "");
+            surface.sourceName = xml.getValue("source:source-name", "");
+            surface.perspectiveWarping = xml.getValue("properties:perspectiveWarping", 0) == 1;
+
+            xml.popTag();
+
+            if(surface.vertices.size() != surface.texCoords.size() || surface.vertices.size() < 3){
+                ofLogWarning("SurfaceLayout") << "skipping malformed surface " << s << " in preset " << p;
+                continue;
+            }
+            presets.back().push_back(surface);
+        }
+        xml.popTag();
+    }
+    return true;
+}
+
+int SurfaceLayout::getNumPresets(){
+    return presets.size();
+}
+
+vector<SurfaceDef> & SurfaceLayout::getSurfaces(int preset){
+    return presets.at(preset);
+}
+
+void SurfaceLayout::addSurfaceToMesh(SurfaceDef & surface, ofMesh & mesh, ofRectangle texRegion,
+                                     const ofRectangle * clampTo){
+    vector<ofVec2f> & v = surface.vertices;
+    vector<ofVec2f> tex;
+    for(unsigned int i = 0; i < surface.texCoords.size(); i++){
+        ofVec2f t(texRegion.x + surface.texCoords[i].x * texRegion.width,
+                  texRegion.y + surface.texCoords[i].y * texRegion.height);
+        if(clampTo != NULL){
+            t.x = ofClamp(t.x, clampTo->getLeft(), clampTo->getRight());
+            t.y = ofClamp(t.y, clampTo->getTop(), clampTo->getBottom());
+        }
+        tex.push_back(t);
+    }
+    unsigned int base = mesh.getNumVertices();
+
+    if(surface.type == SURFACE_TYPE_QUAD && v.size() == 4 && surface.perspectiveWarping){
+        // bake the projective warp into a grid so the result can be merged with
+        // other surfaces and drawn without a per-surface matrix
+        int res = 8;
+        for(int y = 0; y <= res; y++){
+            for(int x = 0; x <= res; x++){
+                float u = x / (float)res;
+                float w = y / (float)res;
+                mesh.addVertex(projectQuad(&v[0], u, w));
+                mesh.addTexCoord(tex[0] * ((1 - u) * (1 - w)) + tex[1] * (u * (1 - w))
+                               + tex[2] * (u * w) + tex[3] * ((1 - u) * w));
+            }
+        }
+        for(int y = 0; y < res; y++){
+            for(int x = 0; x < res; x++){
+                unsigned int i = base + y * (res + 1) + x;
+                mesh.addTriangle(i, i + 1, i + res + 2);
+                mesh.addTriangle(i, i + res + 2, i + res + 1);
+            }
+        }
+        return;
+    }
+
+    // triangles, plain quads and anything else are drawn as a fan
+    for(unsigned int i = 0; i < v.size(); i++){
+        mesh.addVertex(v[i]);
+        mesh.addTexCoord(tex[i]);
+    }
+    for(unsigned int i = 1; i + 1 < v.size(); i++){
+        mesh.addTriangle(base, base + i, base + i + 1);
+    }
+}
+
+// Maps (u, v) in the unit square onto the quad c[0..3] (top-left, top-right,
+// bottom-right, bottom-left) with a perspective transform.
+ofVec2f SurfaceLayout::projectQuad(ofVec2f * c, float u, float v){
+    float dx1 = c[1].x - c[2].x, dx2 = c[3].x - c[2].x, dx3 = c[0].x - c[1].x + c[2].x - c[3].x;
+    float dy1 = c[1].y - c[2].y, dy2 = c[3].y - c[2].y, dy3 = c[0].y - c[1].y + c[2].y - c[3].y;
+    float g = 0, h = 0;
+    float det = dx1 * dy2 - dx2 * dy1;
+    if((dx3 != 0 || dy3 != 0) && det != 0){
+        g = (dx3 * dy2 - dx2 * dy3) / det;
+        h = (dx1 * dy3 - dx3 * dy1) / det;
+    }
+    float a = c[1].x - c[0].x + g * c[1].x;
+    float b = c[3].x - c[0].x + h * c[3].x;
+    float d = c[1].y - c[0].y + g * c[1].y;
+    float e = c[3].y - c[0].y + h * c[3].y;
+    float w = g * u + h * v + 1;
+    return ofVec2f((a * u + b * v + c[0].x) / w, (d * u + e * v + c[0].y) / w);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxXmlSettings.h"
+#include "SurfaceDef.h"
+
+// Read-only copy of the surfaces piMapper keeps in ofxpimapper.xml, one list
+// of surfaces per preset. Used to draw mapped surfaces ourselves when all of
+// them can be sampled from textures we own.
+class SurfaceLayout {
+    public:
+        bool load(string xmlFile);
+        int getNumPresets();
+        vector<SurfaceDef> & getSurfaces(int preset);
+
+        // Appends the warped geometry of a surface as triangles. texRegion is the
+        // normalized sub-rectangle of the bound texture the source lives in.
+        // Texture coordinates are kept inside clampTo if given, piMapper
+        // stores some slightly outside [0, 1].
+        static void addSurfaceToMesh(SurfaceDef & surface, ofMesh & mesh, ofRectangle texRegion,
+                                     const ofRectangle * clampTo = NULL);
+
+        vector< vector<SurfaceDef> > presets;
+        string fileName;
+
+    private:
+        static ofVec2f projectQuad(ofVec2f * corners, float u, float v);
+};
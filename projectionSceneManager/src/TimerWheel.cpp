@@ -0,0 +1,204 @@
+#include "TimerWheel.h"
+
+TimerWheel * TimerWheel::_instance = 0;
+
+TimerWheel * TimerWheel::instance(){
+    if(_instance == 0){
+        _instance = new TimerWheel();
+    }
+    return _instance;
+}
+
+TimerWheel::TimerWheel(){
+    current = 0;
+    nextId = 1;
+}
+
+TimerWheel::~TimerWheel(){
+    // every timer, cancelled or not, sits in exactly one slot
+    for(int i = 0; i < 256; i++){
+        for(unsigned int t = 0; t < level0[i].size(); t++) delete level0[i][t];
+    }
+    for(int l = 0; l < 3; l++){
+        for(int i = 0; i < 64; i++){
+            for(unsigned int t = 0; t < levels[l][i].size(); t++) delete levels[l][i][t];
+        }
+    }
+    for(unsigned int t = 0; t < overflow.size(); t++) delete overflow[t];
+}
+
+uint64_t TimerWheel::now(){
+    return current;
+}
+
+float TimerWheel::nowf(){
+    return current / 1000.0f;
+}
+
+int TimerWheel::getNumPending(){
+    return pending.size();
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t delayMillis, Callback callback){
+    return scheduleAt(current + delayMillis, callback);
+}
+
+TimerWheel::TimerId TimerWheel::scheduleAt(uint64_t timeMillis, Callback callback){
+    Timer * timer = new Timer();
+    timer->id = nextId++;
+    timer->expires = timeMillis;
+    timer->period = 0;
+    timer->callback = callback;
+    pending[timer->id] = timer;
+    insert(timer);
+    return timer->id;
+}
+
+TimerWheel::TimerId TimerWheel::scheduleEvery(uint64_t periodMillis, Callback callback){
+    if(periodMillis == 0) periodMillis = 1;
+    TimerId id = scheduleAt(current + periodMillis, callback);
+    pending[id]->period = periodMillis;
+    return id;
+}
+
+// The slot keeps its pointer until it is visited, the timer is only
+// forgotten here so cancelling stays O(1)
+bool TimerWheel::cancel(TimerId id){
+    std::unordered_map<TimerId, Timer *>::iterator it = pending.find(id);
+    if(it == pending.end()) return false;
+    it->second->callback = Callback();
+    it->second->period = 0;
+    pending.erase(it);
+    return true;
+}
+
+bool TimerWheel::isScheduled(TimerId id){
+    return pending.find(id) != pending.end();
+}
+
+uint64_t TimerWheel::getExpiry(TimerId id){
+    std::unordered_map<TimerId, Timer *>::iterator it = pending.find(id);
+    return it == pending.end() ? 0 : it->second->expires;
+}
+
+void TimerWheel::advance(uint64_t nowMillis){
+    // nothing to fire on the way, skip ahead
+    if(pending.empty() && overflow.empty()){
+        bool empty = true;
+        for(int i = 0; i < 256 && empty; i++) empty = level0[i].empty();
+        for(int l = 0; l < 3 && empty; l++){
+            for(int i = 0; i < 64 && empty; i++) empty = levels[l][i].empty();
+        }
+        if(empty && nowMillis > current){
+            current = nowMillis;
+            return;
+        }
+    }
+
+    while(current < nowMillis){
+        current++;
+        int index = current & 255;
+        if(index == 0){
+            int i1 = (current >> 8) & 63;
+            if(i1 == 0){
+                int i2 = (current >> 14) & 63;
+                if(i2 == 0){
+                    int i3 = (current >> 20) & 63;
+                    if(i3 == 0){
+                        Slot far;
+                        far.swap(overflow);
+                        for(unsigned int i = 0; i < far.size(); i++) reinsert(far[i]);
+                    }
+                    cascade(2, i3);
+                }
+                cascade(1, i2);
+            }
+            cascade(0, i1);
+        }
+        if(!level0[index].empty()){
+            Slot slot;
+            slot.swap(level0[index]);
+            runExpired(slot);
+        }
+    }
+}
+
+int64_t TimerWheel::rebase(uint64_t nowMillis){
+    int64_t delta = (int64_t)nowMillis - (int64_t)current;
+    if(delta == 0) return 0;
+
+    Slot timers;
+    for(int i = 0; i < 256; i++) takeAll(level0[i], timers);
+    for(int l = 0; l < 3; l++){
+        for(int i = 0; i < 64; i++) takeAll(levels[l][i], timers);
+    }
+    takeAll(overflow, timers);
+
+    // pending timers all lie after the old clock, so after the new one too
+    current = nowMillis;
+    for(unsigned int i = 0; i < timers.size(); i++){
+        timers[i]->expires += delta;
+        insert(timers[i]);
+    }
+    return delta;
+}
+
+// cancelled timers are dropped on the way
+void TimerWheel::takeAll(Slot & slot, Slot & timers){
+    for(unsigned int i = 0; i < slot.size(); i++){
+        if(slot[i]->callback) timers.push_back(slot[i]);
+        else delete slot[i];
+    }
+    slot.clear();
+}
+
+void TimerWheel::insert(Timer * timer){
+    // something scheduled in the past fires on the next tick
+    if(timer->expires <= current) timer->expires = current + 1;
+    uint64_t delta = timer->expires - current;
+
+    if(delta < 256) level0[timer->expires & 255].push_back(timer);
+    else if(delta < (1 << 14)) levels[0][(timer->expires >> 8) & 63].push_back(timer);
+    else if(delta < (1 << 20)) levels[1][(timer->expires >> 14) & 63].push_back(timer);
+    else if(delta < (1 << 26)) levels[2][(timer->expires >> 20) & 63].push_back(timer);
+    else overflow.push_back(timer);
+}
+
+void TimerWheel::cascade(int level, int index){
+    Slot slot;
+    slot.swap(levels[level][index]);
+    for(unsigned int i = 0; i < slot.size(); i++){
+        if(!slot[i]->callback){
+            delete slot[i]; // cancelled
+            continue;
+        }
+        reinsert(slot[i]);
+    }
+}
+
+// Moving down a level, a timer due on this very tick goes into the slot
+// that is about to run instead of being pushed to the next tick
+void TimerWheel::reinsert(Timer * timer){
+    if(timer->expires == current) level0[current & 255].push_back(timer);
+    else insert(timer);
+}
+
+void TimerWheel::runExpired(Slot & slot){
+    for(unsigned int i = 0; i < slot.size(); i++){
+        Timer * timer = slot[i];
+        // cancelled before, or by an earlier callback of this tick
+        if(!timer->callback){
+            delete timer;
+            continue;
+        }
+        Callback callback = timer->callback;
+        if(timer->period > 0){
+            timer->expires += timer->period;
+            insert(timer);
+        } else {
+            pending.erase(timer->id);
+            delete timer;
+        }
+        callback();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include <unordered_map>
+
+// Hierarchical timer wheel with millisecond resolution.
+//
+// Game and scene logic schedule callbacks on it instead of comparing
+// ofGetElapsedTimeMillis() against saved start times every frame. The app
+// reads the clock once per frame and passes it to advance(), which fires
+// every timer that expired since the last call, in order of expiry.
+// Everything else asks now() for the time of the current frame.
+//
+// Four levels of 256, 64, 64 and 64 slots cover about 18 hours. Timers
+// further out wait in an overflow list. Inserting and cancelling a timer is
+// O(1) on average (the ids are found in a hash map), and each timer is
+// moved down a level at most three times.
+class TimerWheel {
+    public:
+        typedef uint64_t TimerId;
+        typedef std::function<void()> Callback;
+
+        // The wheel shared by all sources and the scene manager
+        static TimerWheel * instance();
+
+        TimerWheel();
+        ~TimerWheel();
+
+        void advance(uint64_t nowMillis);
+        // Moves the clock to nowMillis without firing what lies between,
+        // for a clock that was stepped. Pending timers keep the time they had
+        // left. Returns the shift, owners of absolute times add it to theirs.
+        int64_t rebase(uint64_t nowMillis);
+        uint64_t now();
+        float nowf(); // seconds, like ofGetElapsedTimef()
+
+        TimerId schedule(uint64_t delayMillis, Callback callback);
+        TimerId scheduleAt(uint64_t timeMillis, Callback callback);
+        TimerId scheduleEvery(uint64_t periodMillis, Callback callback);
+        bool cancel(TimerId id);
+        bool isScheduled(TimerId id);
+        uint64_t getExpiry(TimerId id);
+
+        int getNumPending();
+
+    private:
+        struct Timer {
+            TimerId id;
+            uint64_t expires;
+            uint64_t period;
+            Callback callback;
+        };
+        typedef std::vector<Timer *> Slot;
+
+        void insert(Timer * timer);
+        void reinsert(Timer * timer);
+        void cascade(int level, int index);
+        void runExpired(Slot & slot);
+        void takeAll(Slot & slot, Slot & timers);
+
+        static TimerWheel * _instance;
+
+        Slot level0[256];
+        Slot levels[3][64];
+        Slot overflow;
+        std::unordered_map<TimerId, Timer *> pending;
+
+        uint64_t current;
+        TimerId nextId;
+};
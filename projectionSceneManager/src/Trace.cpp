@@ -0,0 +1,133 @@
+#include "Trace.h"
+#include <cstdio>
+#include <csignal>
+#include <thread>
+
+Trace * Trace::_instance = 0;
+
+Trace * Trace::instance(){
+    if(_instance == 0){
+        _instance = new Trace();
+    }
+    return _instance;
+}
+
+Trace::Trace(){
+    enabled = true;
+    pendingDump = false;
+}
+
+void Trace::setEnabled(bool _enabled){
+    enabled = _enabled;
+}
+
+bool Trace::isEnabled(){
+    return enabled;
+}
+
+void Trace::setThreadName(string name){
+    ThreadRing * ring = getRing();
+    std::lock_guard<std::mutex> guard(ringsMutex);
+    ring->name = name;
+}
+
+// The ring is created the first time a thread records and lives as long as
+// the process, the dump may still read it after the thread has ended
+Trace::ThreadRing * Trace::getRing(){
+    static thread_local ThreadRing * ring = 0;
+    if(ring == 0){
+        ring = new ThreadRing();
+        std::lock_guard<std::mutex> guard(ringsMutex);
+        ring->tid = rings.size() + 1;
+        ring->name = "thread " + ofToString(ring->tid);
+        rings.push_back(ring);
+    }
+    return ring;
+}
+
+//--------------------------------------------------------------
+void Trace::requestDump(){
+    pendingDump.store(true);
+}
+
+bool Trace::dumpRequested(){
+    return pendingDump.exchange(false);
+}
+
+static void onDumpSignal(int){
+    Trace::instance()->requestDump();
+}
+
+void Trace::installSignalHandler(){
+    instance();
+#ifdef __linux__
+    signal(SIGUSR1, onDumpSignal);
+#endif
+}
+
+// Each thread keeps writing while its ring is copied. Whatever it may have
+// overwritten during the copy is left out, judged by the count before and
+// after.
+string Trace::dump(){
+    vector<Snapshot> * snapshots = new vector<Snapshot>();
+    {
+        std::lock_guard<std::mutex> guard(ringsMutex);
+        for(unsigned int r = 0; r < rings.size(); r++){
+            ThreadRing * ring = rings[r];
+            uint64_t end = ring->written.load(std::memory_order_acquire);
+            uint64_t begin = end > Capacity ? end - Capacity : 0;
+            Snapshot snapshot;
+            snapshot.tid = ring->tid;
+            snapshot.name = ring->name;
+            snapshot.events.reserve(end - begin);
+            for(uint64_t i = begin; i < end; i++) snapshot.events.push_back(ring->events[i & (Capacity - 1)]);
+            uint64_t after = ring->written.load(std::memory_order_acquire);
+            uint64_t firstValid = after >= Capacity ? after - Capacity + 1 : 0;
+            if(firstValid > begin){
+                snapshot.events.erase(snapshot.events.begin(), snapshot.events.begin() + MIN(firstValid - begin, end - begin));
+            }
+            snapshots->push_back(snapshot);
+        }
+    }
+
+    ofDirectory::createDirectory("traces", true, true);
+    string path = ofToDataPath("traces/trace-" + ofGetTimestampString("%Y%m%d-%H%M%S") + ".json", true);
+    std::thread(write, path, snapshots).detach();
+    return path;
+}
+
+void Trace::write(string path, vector<Snapshot> * snapshots){
+    FILE * file = fopen(path.c_str(), "w");
+    if(file == NULL){
+        ofLogError("Trace") << "could not write " << path;
+        delete snapshots;
+        return;
+    }
+    // timestamps are relative to the earliest start, in micros as the format
+    // wants. Zones are recorded as they close, an enclosing zone comes after
+    // the ones inside it, so the first event need not be the earliest.
+    uint64_t origin = UINT64_MAX;
+    int count = 0;
+    for(unsigned int s = 0; s < snapshots->size(); s++){
+        vector<Event> & events = (*snapshots)[s].events;
+        for(unsigned int i = 0; i < events.size(); i++) origin = MIN(origin, events[i].start);
+        count += events.size();
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"projectionSceneManager\"}}");
+    for(unsigned int s = 0; s < snapshots->size(); s++){
+        Snapshot & snapshot = (*snapshots)[s];
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                snapshot.tid, snapshot.name.c_str());
+        for(unsigned int i = 0; i < snapshot.events.size(); i++){
+            Event & event = snapshot.events[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    event.name, snapshot.tid, (event.start - origin) / 1000.0, event.duration / 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    ofLogNotice("Trace") << "wrote " << count << " zones to " << path;
+    delete snapshots;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// Flight recorder for frame phases.
+//
+// TRACE_ZONE("name") at the top of a scope records when the scope was
+// entered and left into a ring of the calling thread. The rings always
+// hold the last few seconds (16384 zones per thread), older zones are
+// overwritten, so there is nothing to start before a stutter happens.
+// dump() writes what the rings hold as a Chrome trace, to be opened in
+// chrome://tracing or ui.perfetto.dev.
+//
+// A zone costs two clock reads and a store. Names must be string
+// literals, only the pointer is kept.
+class Trace {
+    public:
+        static Trace * instance();
+
+        void setEnabled(bool _enabled);
+        bool isEnabled();
+        // shown as the track name in the trace viewer
+        void setThreadName(string name);
+
+        static uint64_t now(){
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void record(const char * name, uint64_t start, uint64_t end){
+            if(!enabled.load(std::memory_order_relaxed)) return;
+            ThreadRing * ring = getRing();
+            uint64_t index = ring->written.load(std::memory_order_relaxed);
+            Event & event = ring->events[index & (Capacity - 1)];
+            event.name = name;
+            event.start = start;
+            event.duration = MIN(end - start, (uint64_t)UINT32_MAX);
+            ring->written.store(index + 1, std::memory_order_release);
+        }
+
+        // Safe to call from a signal handler, the dump itself happens
+        // when the main thread asks dumpRequested()
+        void requestDump();
+        bool dumpRequested();
+        // sends SIGUSR1 to requestDump()
+        void installSignalHandler();
+
+        // Copies the rings and writes them out on a background thread,
+        // returns the file name
+        string dump();
+
+    private:
+        static const int Capacity = 16384;
+
+        struct Event {
+            const char * name;
+            uint64_t start;     // nanos
+            uint32_t duration;  // nanos
+        };
+
+        struct ThreadRing {
+            ThreadRing() : events(Capacity) {
+                written = 0;
+            }
+            vector<Event> events;
+            std::atomic<uint64_t> written;
+            int tid;
+            string name;
+        };
+
+        struct Snapshot {
+            int tid;
+            string name;
+            vector<Event> events;
+        };
+
+        Trace();
+
+        ThreadRing * getRing();
+        static void write(string path, vector<Snapshot> * snapshots);
+
+        static Trace * _instance;
+
+        std::atomic<bool> enabled;
+        std::atomic<bool> pendingDump;
+
+        std::mutex ringsMutex;
+        vector<ThreadRing *> rings;
+};
+
+// Records the enclosing scope
+class TraceZone {
+    public:
+        TraceZone(const char * _name){
+            name = _name;
+            start = Trace::now();
+        }
+        ~TraceZone(){
+            Trace::instance()->record(name, start, Trace::now());
+        }
+
+    private:
+        const char * name;
+        uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
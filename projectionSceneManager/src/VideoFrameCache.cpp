@@ -0,0 +1,169 @@
+#include "VideoFrameCache.h"
+
+VideoFrameCache * VideoFrameCache::_instance = 0;
+
+VideoFrameCache * VideoFrameCache::instance(){
+    if(_instance == 0){
+        _instance = new VideoFrameCache();
+    }
+    return _instance;
+}
+
+VideoFrameCache::VideoFrameCache(){
+    _budget = 64 * 1024 * 1024;
+    _used = 0;
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
+}
+
+void VideoFrameCache::setBudget(uint64_t bytes){
+    _budget = bytes;
+    evictFor(0);
+}
+
+uint64_t VideoFrameCache::getBudget(){
+    return _budget;
+}
+
+bool VideoFrameCache::isComplete(string clip){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    return it != _clips.end() && it->second.complete;
+}
+
+void VideoFrameCache::beginClip(string clip, float duration){
+    removeClip(clip);
+    Clip & c = _clips[clip];
+    c.bytes = 0;
+    c.duration = duration;
+    c.complete = false;
+    _lru.push_front(clip);
+    _counters[clip].decodes++;
+}
+
+void VideoFrameCache::countDecodedFrame(string clip){
+    _misses++;
+    _counters[clip].misses++;
+}
+
+bool VideoFrameCache::addFrame(string clip, ofPixels & pixels){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    if(it == _clips.end()) return false;
+
+    uint64_t bytes = pixels.getTotalBytes();
+    if(bytes > _budget){
+        // a single frame larger than the whole budget can never be cached
+        removeClip(clip);
+        return false;
+    }
+    evictFor(bytes);
+    if(_used + bytes > _budget){
+        // the clip itself does not fit, give up on it rather than thrash
+        removeClip(clip);
+        return false;
+    }
+    it->second.frames.push_back(pixels);
+    it->second.bytes += bytes;
+    _used += bytes;
+    return true;
+}
+
+void VideoFrameCache::endClip(string clip){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    if(it == _clips.end()) return;
+    it->second.complete = !it->second.frames.empty();
+    if(it->second.duration <= 0){
+        // the decoder did not know the length, assume the usual 25 fps
+        it->second.duration = it->second.frames.size() / 25.0f;
+    }
+    touch(clip);
+}
+
+void VideoFrameCache::removeClip(string clip){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    if(it == _clips.end()) return;
+    _used -= it->second.bytes;
+    _clips.erase(it);
+    _lru.remove(clip);
+}
+
+ofPixels * VideoFrameCache::getFrame(string clip, int frame){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    if(it == _clips.end() || !it->second.complete) return NULL;
+    _hits++;
+    _counters[clip].hits++;
+    touch(clip);
+    vector<ofPixels> & frames = it->second.frames;
+    return &frames[frame % frames.size()];
+}
+
+int VideoFrameCache::getNumFrames(string clip){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    if(it == _clips.end()) return 0;
+    return it->second.frames.size();
+}
+
+float VideoFrameCache::getDuration(string clip){
+    map<string, Clip>::iterator it = _clips.find(clip);
+    if(it == _clips.end()) return 0;
+    return it->second.duration;
+}
+
+VideoFrameCache::Stats VideoFrameCache::getStats(){
+    Stats s;
+    s.budgetBytes = _budget;
+    s.usedBytes = _used;
+    s.hits = _hits;
+    s.misses = _misses;
+    s.evictions = _evictions;
+    s.numClips = _clips.size();
+    s.numCompleteClips = 0;
+    for(map<string, Clip>::iterator it = _clips.begin(); it != _clips.end(); ++it){
+        if(it->second.complete) s.numCompleteClips++;
+    }
+    return s;
+}
+
+string VideoFrameCache::getStatsString(){
+    Stats s = getStats();
+    uint64_t lookups = s.hits + s.misses;
+    float hitRate = lookups > 0 ? 100.0f * s.hits / lookups : 0;
+    string stats = "video cache: " + ofToString(s.usedBytes / 1024) + "/" + ofToString(s.budgetBytes / 1024) + " KiB, "
+        + ofToString(s.numCompleteClips) + "/" + ofToString(s.numClips) + " clips complete, "
+        + "hit rate " + ofToString(hitRate, 1) + "% (" + ofToString(s.hits) + " hits, " + ofToString(s.misses) + " misses), "
+        + ofToString(s.evictions) + " evictions";
+    // more than one decode means the clip was evicted and decoded again
+    for(map<string, ClipCounters>::iterator it = _counters.begin(); it != _counters.end(); ++it){
+        ClipCounters & c = it->second;
+        uint64_t frames = c.hits + c.misses;
+        stats += "\n  " + it->first + ": hit rate " + ofToString(frames > 0 ? 100.0f * c.hits / frames : 0, 1) + "%, "
+            + ofToString(c.decodes) + " decodes, " + ofToString(c.evictions) + " evictions";
+    }
+    return stats;
+}
+
+void VideoFrameCache::resetCounters(){
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
+    _counters.clear();
+}
+
+void VideoFrameCache::touch(string clip){
+    _lru.remove(clip);
+    _lru.push_front(clip);
+}
+
+// Drop least recently used clips until `bytes` more fit in the budget.
+// Clips still being filled are never evicted, their sources would lose
+// the frames captured so far and give up on caching.
+void VideoFrameCache::evictFor(uint64_t bytes){
+    while(_used + bytes > _budget){
+        list<string>::reverse_iterator victim = _lru.rbegin();
+        while(victim != _lru.rend() && !_clips[*victim].complete) ++victim;
+        if(victim == _lru.rend()) return;
+        _counters[*victim].evictions++;
+        removeClip(*victim);
+        _evictions++;
+    }
+}
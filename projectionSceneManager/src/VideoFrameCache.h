@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ofMain.h"
+
+// Process-wide store of decoded video frames, shared by all CachedVideoSources.
+// Clips are kept as downscaled raw pixels. When the memory budget is exceeded
+// the least recently used clip is evicted as a whole.
+//
+// Hits and misses are counted per frame shown: a hit is a frame from the
+// cache, a miss one the decoder had to produce. Decodes and evictions are
+// kept per clip, clips that keep evicting each other show up there.
+class VideoFrameCache {
+    public:
+        struct Stats {
+            uint64_t budgetBytes;
+            uint64_t usedBytes;
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            int numClips;
+            int numCompleteClips;
+        };
+
+        static VideoFrameCache * instance();
+
+        void setBudget(uint64_t bytes);
+        uint64_t getBudget();
+
+        // Decoding side: called while a clip is played for the first time
+        bool isComplete(string clip);
+        void beginClip(string clip, float duration);
+        // a frame shown straight from the decoder
+        void countDecodedFrame(string clip);
+        bool addFrame(string clip, ofPixels & pixels);
+        void endClip(string clip);
+        void removeClip(string clip);
+
+        // Playback side: returns NULL if the clip is not fully cached, a
+        // frame that is returned counts as a hit
+        ofPixels * getFrame(string clip, int frame);
+        int getNumFrames(string clip);
+        // seconds, the length of the clip however many frames were captured
+        float getDuration(string clip);
+
+        Stats getStats();
+        string getStatsString();
+        void resetCounters();
+
+    private:
+        static VideoFrameCache * _instance;
+
+        VideoFrameCache();
+
+        struct Clip {
+            vector<ofPixels> frames;
+            uint64_t bytes;
+            float duration;
+            bool complete;
+        };
+        // outlive the clip's frames, an evicted clip is decoded again
+        struct ClipCounters {
+            uint64_t hits;
+            uint64_t misses;
+            int decodes;
+            int evictions;
+        };
+
+        void touch(string clip);
+        void evictFor(uint64_t bytes);
+
+        map<string, Clip> _clips;
+        map<string, ClipCounters> _counters;
+        list<string> _lru; // front = most recently used
+        uint64_t _budget;
+        uint64_t _used;
+        uint64_t _hits;
+        uint64_t _misses;
+        uint64_t _evictions;
+};
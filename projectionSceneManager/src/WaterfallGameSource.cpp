@@ -1,18 +1,62 @@
 #include "WaterfallGameSource.h"
 #include "ofxGPIO.h"
+#include "Settings.h"
 //--------------------------------------------------------------
+WaterfallGameConfig::WaterfallGameConfig(){
+    name = "Waterfall Game FBO Source";
+    gpioPin = "17";
+    width = 800;
+    height = 480;
+    fieldParticles = 75;
+    drops = 50;
+    atoms = 5;
+    gridResolution = 20;
+    lineDistance = 90;
+    gameTotalTime = 60000*3;
+    shockTotalTime = 3000;
+    tickRate = 20;
+    idleTimeout = 60000*2;
+    attractTickRate = 5;
+    attractDensity = 0.3;
+    reducedFill = false;
+}
+
+//--------------------------------------------------------------
+WaterfallGameSource::WaterfallGameSource(){
+    gameTimer = shockTimer = idleTimer = 0;
+    attract = false;
+    lastTick = 0;
+    tickSeconds = 0.05;
+}
+
+WaterfallGameSource::~WaterfallGameSource(){
+    // the callbacks point back at this source
+    cancelTimers();
+    TimerWheel::instance()->cancel(idleTimer);
+    Settings::instance()->removeParameters(name);
+}
 
 //--------------------------------------------------------------
 // main setup
 void WaterfallGameSource::setup(){
+    setup(WaterfallGameConfig());
+}
+void WaterfallGameSource::setup(const WaterfallGameConfig & _config){
+    config = _config;
     // Give our source a decent name
-    name = "Waterfall Game FBO Source";
+    name = config.name;
+    // settings.json and --set may change the config before anything is built
+    addParameters();
     // Allocate our FBO source, decide how big it should be
-    allocate(800, 480);
+    allocate(config.width, config.height);
     //Pinout
-    gpio17.setup("17");
-    gpio17.export_gpio();
-    gpio17.setdir_gpio("in");
+    button.setup(config.gpioPin);
+    button.export_gpio();
+    button.setdir_gpio("in");
+
+    geometry = WaterfallGeometry::acquire();
+    applyTickRate();
+    lastTick = TimerWheel::instance()->now();
 
     screenWidth = fbo->getWidth();
     screenHeight = fbo->getHeight();
@@ -21,11 +65,27 @@ void WaterfallGameSource::setup(){
     waterFallAreaY = screenHeight/3;
     fieldCentreX = screenWidth - offset;
 
+    area.width = screenWidth;
+    area.height = screenHeight;
+    area.offset = offset;
+    area.fallX = waterFallAreaX;
+    area.fallY = waterFallAreaY;
+
+    // ring i of drawIslandRings() is lerped i/12 of the way to the second colour
+    islePalette.setGradient(6, 1 / 12.0, 6 / 12.0);
+    atomPalette.load("palettes.json", "atoms");
+    islePalette.load("palettes.json", "islands");
+
     setupGenField();
     setupWaterfall();
     setupAtoms();
     gameReset();
 
+    load.setup({ "playing", "attract" });
+    lastCaughtCount = caughtCount;
+    lastEndGame = endGame;
+    noteActivity();
+
 
 
 }
@@ -33,107 +93,59 @@ void WaterfallGameSource::setName(string _name){
     name = _name;
 }
 void WaterfallGameSource::gameReset(){
-    ofSetVerticalSync(true);
-    ofSetCircleResolution(20);
-
-    atomRed = false;
-    isleRed = false;
+    cancelTimers();
     atomState = 0;
-    atomStartTime = ofGetElapsedTimeMillis();
-    shockSavedTime = ofGetElapsedTimeMillis();
-    shockTotalTime = 3000;
-    isleStartTime = ofGetElapsedTimeMillis();
-    gameSavedTime = ofGetElapsedTimeMillis();
-    gameTotalTime = 60000*3;
+    shockTotalTime = config.shockTotalTime;
+    gameTotalTime = config.gameTotalTime;
+    gameTimedOut = false;
     caughtCount = 0;
     buttonHits = 0;
     endGame = false;
 
-    setupIslandRings();
-        //atom setup
-        for (unsigned int i = 0; i < atoms.size(); i++){
-            atomParticle* tmpAtom = atoms.at(i);
-
-            tmpAtom->pos.x = ofRandom(waterFallAreaX,screenWidth);
-            tmpAtom->pos.y = ofRandom(screenHeight);
+    // end game timer if someone plays but doesn't complete
+    gameTimer = TimerWheel::instance()->schedule(gameTotalTime, [this](){ gameTimedOut = true; });
+    atomPalette.restart(TimerWheel::instance()->now());
+    islePalette.restart(TimerWheel::instance()->now());
 
-            tmpAtom->vel.x = ofRandom(-3.9, 3.9);
-            tmpAtom->vel.y = ofRandom(-3.9, 3.9);
-
-            tmpAtom->isDead  = 0;            
-        }
+    setupIslandRings();
+    //bring back all atoms caught in the last game
+    atoms.reviveAll();
 }
 //---------------------------------------------------------------
 // Setup functions for all game objects
 void WaterfallGameSource::setupGenField(){
     // Initialize particles
-    int particleAmount = 75;
-    for( int i = 0; i < particleAmount; i++ )
-    {
-        Particle* tmpParticle = new Particle();
-
-        tmpParticle->pos.set(ofRandom(waterFallAreaX,screenWidth), ofRandom(screenHeight) );
-
-        float tmpAngle = ofRandom( PI * 2.0f );
-        float magnitude = 20.0f; // pixels per second
-        tmpParticle->vel.set( cosf(tmpAngle) * magnitude, sinf(tmpAngle) * magnitude );
-
-        tmpParticle->spacePartitioningIndexX = 0;
-        tmpParticle->spacePartitioningIndexY = 0;
-
-        tmpParticle->myID = i;
-
-        particles.push_back( tmpParticle );
-    }
+    int particleAmount = config.fieldParticles;
+    genField.emitter.area = &area;
+    genField.boundary.area = &area;
+    genField.spawn(particleAmount);
 
     // Initialize storage we will use to optimize particle-to-particle distance checks
-    spacePartitioningResX = 20;
-    spacePartitioningResY = 20;
-
-    spacePartitioningGridWidth = screenWidth / (float)spacePartitioningResX;
-    spacePartitioningGridHeight= screenHeight / (float)spacePartitioningResY;
-
-    for( int y = 0; y < spacePartitioningResY; y++ )
-    {
-        spacePartitioningGrid.push_back( vector< vector< Particle* > >() );
-        for( int x = 0; x < spacePartitioningResX; x++ )
-        {
-            spacePartitioningGrid.at(y).push_back( vector< Particle* >() );
-        }
-    }
-    lastUpdateTime = ofGetElapsedTimef();
+    applyGrid();
 }
 void WaterfallGameSource:: setupWaterfall(){
-    int dropAmount = 50;
-    for (unsigned int i = 0; i < dropAmount; i++){
-        Drop* tmpDrop = new Drop();
-        tmpDrop->pos.set(ofRandom(0,waterFallAreaX*2), ofRandom(waterFallAreaY,screenHeight - waterFallAreaY));
-        tmpDrop->vel.set( fabs(tmpDrop->vel.x) * 3.0, ofRandom(-0.5,0.5) ); //make the particles all be going across;
-        tmpDrop->frc   = ofPoint(0,0,0);
-        tmpDrop->scale = ofRandom(0.5, 1);
-        drops.push_back( tmpDrop );
-    }
-
+    int dropAmount = config.drops;
+    waterfall.emitter.area = &area;
+    waterfall.force.area = &area;
+    waterfall.boundary.area = &area;
+    waterfall.renderer.area = &area;
+    waterfall.renderer.geometry = geometry.get();
+    waterfall.spawn(dropAmount);
 }
 void WaterfallGameSource:: setupAtoms(){
-    int atomAmount = 5;
-    for (unsigned int i = 0; i < atomAmount; i++){
-        atomParticle* tmpAtom = new atomParticle();
-
-        //the unique val allows us to set properties slightly differently for each particle
-        tmpAtom->uniqueVal = ofRandom(-10000, 10000);
-
-        tmpAtom->frc   = ofPoint(0,0,0);
-        tmpAtom->drag  = ofRandom(0.98, 1);
-
-        tmpAtom->scale = ofRandom(0.5, 1.0);
-
-        tmpAtom->phase = 0;
-        tmpAtom->pSpeed = ofRandom(-25,25);
-
-        atoms.push_back( tmpAtom );
-
-    }
+    int atomAmount = config.atoms;
+    atoms.emitter.area = &area;
+    atoms.boundary.area = &area;
+    atoms.renderer.geometry = geometry.get();
+    atoms.spawn(atomAmount);
+
+    // one island for now, moved to the ring position every update
+    islandField.setup(screenWidth, screenHeight, 200);
+    islandField.clear();
+    islandField.add(fieldCentreX, screenHeight/2, 150, -0.8);
+    shockField.setup(screenWidth, screenHeight, 200);
+    atoms.force.islands = &islandField;
+    atomShock.shocks = &shockField;
 }
 void WaterfallGameSource:: setupIslandRings(){
     ringPhase = 0;
@@ -147,7 +159,38 @@ void WaterfallGameSource:: setupIslandRings(){
 //---------------------------------------------------------------
 // Main Update
 void WaterfallGameSource::update(){
-    int gamePassedTime = ofGetElapsedTimeMillis() - gameSavedTime;
+    TRACE_ZONE("WaterfallGameSource::update");
+    // the button checks below read the flags of the current keyframes
+    uint64_t now = TimerWheel::instance()->now();
+    load.frame();
+
+    // the button is read every frame here, the slow ticks would delay waking up
+    if(attract){
+        readButton();
+        if(state_button == "1") leaveAttract();
+    }
+
+    atomPalette.update(now);
+    islePalette.update(now);
+    atomRed = atomPalette.isFlagged();
+    isleRed = islePalette.isFlagged();
+
+    // Fixed steps instead of sleeping the whole app after every update.
+    // After a long stall the backlog is dropped rather than replayed.
+    uint64_t tickMillis = tickSeconds * 1000;
+    int steps = 0;
+    while(now - lastTick >= tickMillis){
+        if(++steps > 5){
+            lastTick = now;
+            break;
+        }
+        tick();
+        lastTick += tickMillis;
+    }
+}
+// One simulation step, the button is sampled once per step too
+void WaterfallGameSource::tick(){
+    TRACE_ZONE("WaterfallGameSource::tick");
     updateGenField();
     updateWaterfall();
     //Game States -----------------------------------------
@@ -157,280 +200,96 @@ void WaterfallGameSource::update(){
         updateAtoms();
         updateIslandRings();
         // end game timer if someone plays but doesn't complete
-        if(caughtCount > 1 && gamePassedTime > gameTotalTime){
-            gameSavedTime = ofGetElapsedTimeMillis();
+        if(caughtCount > 1 && gameTimedOut){
             gameReset();
         }
         // game ended
     }else if (endGame == true){
         water = ofColor(0,200,255,100);
     }
+    if(caughtCount != lastCaughtCount || endGame != lastEndGame){
+        lastCaughtCount = caughtCount;
+        lastEndGame = endGame;
+        noteActivity();
+    }
     //Pinout/button hits
-    gpio17.getval_gpio(state_button);
+    readButton();
     if(state_button == "1"){
+        noteActivity();
         buttonHits++;
         if(atomRed == true && isleRed == true && buttonHits >= 1 && buttonHits <= 5){
-            atomState = 1;
+            startShock();
         } else if (endGame == true){
             gameReset();
         }
     } else if(state_button == "0"){
         buttonHits = 0;
     }
-    usleep(50000);
-    //--------
+}
+// sysfs reads can stall, it gets a zone of its own. A replayed
+// recording takes the place of the pin, see InputLog.
+void WaterfallGameSource::readButton(){
+    TRACE_ZONE("WaterfallGameSource::readButton");
+    InputLog * input = InputLog::instance();
+    bool pressed;
+    if(input->getButton(name, pressed)) state_button = pressed ? "1" : "0";
+    else button.getval_gpio(state_button);
+    input->recordButton(name, state_button == "1");
 }
 //---------------------------------------------------------------
 // Update functions for all game objects
 void WaterfallGameSource::updateGenField(){
-    currTime = ofGetElapsedTimef();
-    timeDelta = currTime - lastUpdateTime;
-    lastUpdateTime = currTime;
-
-
+    TRACE_ZONE("WaterfallGameSource::updateGenField");
     // update particle positions
-    for( unsigned int i = 0; i < particles.size(); i++ )
-    {
-        Particle* tmpParticle = particles.at(i);
-        tmpParticle->pos += tmpParticle->vel * timeDelta;
-
-        tmpParticle->pos.x = fmodf( tmpParticle->pos.x, screenWidth );
-
-        if( tmpParticle->pos.x < waterFallAreaX ) tmpParticle->pos.x += screenWidth;
-
-        tmpParticle->pos.y = fmodf( tmpParticle->pos.y, screenHeight );
-
-        if( tmpParticle->pos.y < 0 ) tmpParticle->pos.y += screenHeight;
-    }
-
-    // clear the space partitioning lists
-    for( int y = 0; y < spacePartitioningResY; y++ )
-    {
-        for( int x = 0; x < spacePartitioningResX; x++ )
-        {
-            spacePartitioningGrid.at(y).at(x).clear();
-        }
-    }
-
-    // add particles into the space partitioning grid
-    for( unsigned int i = 0; i < particles.size(); i++ )
-    {
-        Particle* tmpParticle = particles.at(i);
-
-        int tmpIndexX = tmpParticle->pos.x / spacePartitioningGridWidth;
-        int tmpIndexY = tmpParticle->pos.y / spacePartitioningGridHeight;
-
-        if( tmpIndexX < 0 )  tmpIndexX = 0;
-        if( tmpIndexX >= spacePartitioningResX ) tmpIndexX = spacePartitioningResX-1;
-
-        if( tmpIndexY < 0 )  tmpIndexY = 0;
-        if( tmpIndexY >= spacePartitioningResY ) tmpIndexY = spacePartitioningResY-1;
-
-        tmpParticle->spacePartitioningIndexX = tmpIndexX;
-        tmpParticle->spacePartitioningIndexY = tmpIndexY;
-
-        spacePartitioningGrid.at(tmpIndexY).at(tmpIndexX).push_back( tmpParticle );
-    }
+    genField.force.timeDelta = tickSeconds;
+    genField.update();
 
     // Now we update the line mesh, to do this we check each particle against every other particle, if they are
-    // within a certain distance we draw a line between them. As this quickly becoems a pretty insane amount
-    // of checks, we use our space partitioning scheme to optimize it all a little bit.
-    ofPushStyle();
-    lineMesh.clear();
-    lineMesh.setMode( OF_PRIMITIVE_LINES );
-    ofFloatColor scratchColor;
-    if(endGame == false)scratchColor.set( 0, 1, 0.9);
-    else if (endGame == true)scratchColor.set(1, 1, 1);
-
-    float lineConnectionMaxDistance = 90; //ofMap( cosf( 100 ) , -1.0f, 1.0f, 10.0f, 100.0f); //   ofGetMouseY() / 10.0f;
-    float lineConnectionMaxDistanceSquared = lineConnectionMaxDistance * lineConnectionMaxDistance;
-
-    // how many slots do we need to check on each side?
-    int spacePartitioningIndexDistanceX = ceil(lineConnectionMaxDistance / spacePartitioningGridWidth);
-    int spacePartitioningIndexDistanceY = ceil(lineConnectionMaxDistance / spacePartitioningGridHeight);
-
-    for( unsigned int particleIndex = 0; particleIndex < particles.size(); particleIndex++ )
-    {
-        Particle* tmpParticle = particles.at(particleIndex);
-
-        // the particle knows where it is in the space partitioning grid, figure out which indices to loop between based
-        // on how many slots the maximum line distance  can cover, then do a bounds check.
-        int startIndexX = tmpParticle->spacePartitioningIndexX - spacePartitioningIndexDistanceX;
-        if( startIndexX < 0 ) { startIndexX = 0; } if( startIndexX >= spacePartitioningResX ) { startIndexX = spacePartitioningResX-1;}
-
-        int endIndexX   = tmpParticle->spacePartitioningIndexX + spacePartitioningIndexDistanceX;
-        if( endIndexX < 0 ) { endIndexX = 0; } if( endIndexX >= spacePartitioningResX ) { endIndexX = spacePartitioningResX-1;}
-
-        int startIndexY = tmpParticle->spacePartitioningIndexY - spacePartitioningIndexDistanceY;
-        if( startIndexY < 0 ) { startIndexY = 0; } if( startIndexY >= spacePartitioningResY ) { startIndexY = spacePartitioningResY-1;}
-
-        int endIndexY   = tmpParticle->spacePartitioningIndexY + spacePartitioningIndexDistanceY;
-        if( endIndexY < 0 ) { endIndexY = 0; } if( endIndexY >= spacePartitioningResY ) { endIndexY = spacePartitioningResY-1;}
-
-        for( int y = startIndexY; y < endIndexY; y++ )
-        {
-            for( int x = startIndexX; x < endIndexX; x++ )
-            {
-                for( unsigned int i = 0; i < spacePartitioningGrid.at(y).at(x).size(); i++ )
-                {
-                    Particle* tmpOtherParticle = spacePartitioningGrid.at(y).at(x).at(i);
-                    if( tmpParticle->myID != tmpOtherParticle->myID )
-                    {
-                        ofVec2f diff = tmpParticle->pos - tmpOtherParticle->pos;
-                        if( diff.lengthSquared() < lineConnectionMaxDistanceSquared )
-                        {
-                            scratchColor.a =  1.0f - (diff.length() / lineConnectionMaxDistance);
-
-                            lineMesh.addVertex( tmpParticle->pos );
-                            lineMesh.addColor( scratchColor );
-
-                            lineMesh.addVertex( tmpOtherParticle->pos );
-                            lineMesh.addColor( scratchColor );
-
-                            lineMesh.addIndex( lineMesh.getNumVertices() - 2 );
-                            lineMesh.addIndex( lineMesh.getNumVertices() - 1 );
-                            ofPopStyle();
-                        }
-                    }
-                }
-            }
-        }
-    }
+    // within a certain distance we draw a line between them.
+    if(endGame == false) genField.renderer.color.set(0, 1, 0.9);
+    else if (endGame == true) genField.renderer.color.set(1, 1, 1);
+    genField.renderer.connect(genField.data(), genField.alive());
 }
 void WaterfallGameSource::updateWaterfall(){
-
-    for (unsigned int i = 0; i < drops.size(); i++){
-
-        Drop* tmpDrop = drops.at(i);
-
-        tmpDrop->windY = ofSignedNoise(tmpDrop->pos.y * 0.003, tmpDrop->pos.x * 0.006, ofGetElapsedTimef() * 0.3);
-        tmpDrop->frc.y = tmpDrop->windY * 0.01 + ofSignedNoise(tmpDrop->uniqueVal, tmpDrop->pos.x * 0.02) * 0.3;
-        tmpDrop->frc.x = ofSignedNoise(tmpDrop->uniqueVal, tmpDrop->pos.y * 0.006, ofGetElapsedTimef()*0.2) * 0.09 + 0.18;
-        tmpDrop->vel *= tmpDrop->drag;
-        tmpDrop->vel += tmpDrop->frc * 0.4;
-        tmpDrop->drag  = ofRandom(0.99, 1.05);
-        tmpDrop->uniqueVal = ofRandom(-10000, 10000);
-
-        //we do this so as to skip the bounds check for the bottom and make the particles go back across the screen
-        if( tmpDrop->pos.x + tmpDrop->vel.x > waterFallAreaX + 20){
-            tmpDrop->pos.y = ofRandom(waterFallAreaY, screenHeight - waterFallAreaY);
-            tmpDrop->pos.x -= waterFallAreaX +20;
-            tmpDrop->lifespan = 100;
-        }
-        //2 - UPDATE OUR POSITION
-
-        tmpDrop->pos += tmpDrop->vel;
-        //3 - LIMIT THE PARTICLES TO STAY ON SCREEN
-
-        if( tmpDrop->pos.y > screenHeight - waterFallAreaY && tmpDrop->pos.x < waterFallAreaX ){
-            tmpDrop->pos.y = screenHeight - waterFallAreaY;
-            tmpDrop->vel.y*= -1.0;
-        }
-        else if( tmpDrop->pos.y < waterFallAreaY && tmpDrop->pos.x < waterFallAreaX){
-            tmpDrop->pos.y = waterFallAreaY;
-            tmpDrop->vel.y*= -1.0;
-        }
-        if( tmpDrop->pos.y > screenHeight  && tmpDrop->pos.x < waterFallAreaX*2 && tmpDrop->pos.x > waterFallAreaX){
-            tmpDrop->pos.y = screenHeight;
-            tmpDrop->vel.y*= -1.0;
-        }
-        else if( tmpDrop->pos.y < 0 && tmpDrop->pos.x < waterFallAreaX*2 && tmpDrop->pos.x > waterFallAreaX){
-            tmpDrop->pos.y = 0;
-            tmpDrop->vel.y*= -1.0;
-        }
-        if (tmpDrop->pos.x >offset && tmpDrop->pos.x< waterFallAreaX - 100){
-            tmpDrop->drag = ofRandom(0.91,0.93);
-            tmpDrop->lifespan -=7;
-
-        }else if (tmpDrop->pos.x > waterFallAreaX - 100 && tmpDrop->pos.x < waterFallAreaX+20 ){
-            tmpDrop->frc.y = tmpDrop->windY * 0.04 + ofSignedNoise(tmpDrop->uniqueVal, tmpDrop->pos.x * 0.02) * 0.6;
-            tmpDrop->vel += tmpDrop->frc * 0.45;
-            tmpDrop->drag = ofRandom(0.94,0.96);
-            tmpDrop->lifespan -=8;
-        }
-    }
+    TRACE_ZONE("WaterfallGameSource::updateWaterfall");
+    waterfall.force.time = TimerWheel::instance()->nowf();
+    waterfall.update();
 }
 void WaterfallGameSource:: updateAtoms(){
-
-    for (unsigned int i = 0; i < atoms.size(); i++){
-        atomParticle* tmpAtom = atoms.at(i);
-        tmpAtom->phase += tmpAtom->pSpeed;
-        if( atomState == 0 ){
-
-            ofPoint attractPt(myMouse.x, myMouse.y);
-            tmpAtom->frc = attractPt-tmpAtom->pos;
-
-            //let get the distance and only repel points close to the mouse
-            float dist = tmpAtom->frc.length();
-            tmpAtom->frc.normalize();
-
-            tmpAtom->vel *= tmpAtom->drag;
-
-            if( dist < 150 ){
-                tmpAtom->vel += -tmpAtom->frc * 0.8; //notice the frc is negative
-            }else{
-                //if the particles are not close to us, lets add a little bit of random movement using noise. this is where uniqueVal comes in handy.
-                tmpAtom->frc.x = ofSignedNoise(tmpAtom->uniqueVal, tmpAtom->pos.y * 0.1, ofGetElapsedTimef()*0.2);
-                tmpAtom->frc.y = ofSignedNoise(tmpAtom->uniqueVal, tmpAtom->pos.x * 0.1, ofGetElapsedTimef()*0.2);
-                tmpAtom->vel += tmpAtom->frc * 0.1;
-            }
-        } else if(atomState == 1){
-
-            tmpAtom->vel.x = 0;
-            tmpAtom->vel.y = 0;
-            ofPoint attractPt(myMouse.x, myMouse.y );
-            tmpAtom->frc = attractPt-tmpAtom->pos; // we get the attraction force/vector by looking at the mouse pos relative to our pos
-            //let get the distance and only repel points close to the mouse
-            float dist = tmpAtom->frc.length();
-            if(dist<200 && dist > 100)tmpAtom->vel += tmpAtom->frc * 0.05;
-            else if(dist<100){
-                tmpAtom->vel += tmpAtom->frc * 0.8;
-                tmpAtom->pos.x = screenWidth*100;
-                tmpAtom->isDead = 1;
-                caughtCount++;
-            }
-            if(caughtCount == 10){
-                endGame = true;
-            }
-
-            int shockPassedTime = ofGetElapsedTimeMillis() - shockSavedTime;
-
-            if(shockPassedTime > shockTotalTime ){
-                atomState = 0;
-                shockSavedTime = ofGetElapsedTimeMillis();
-            }
-        }
-
-        //2 - UPDATE OUR POSITION
-
-        tmpAtom->pos += tmpAtom->vel;
-
-
-        //3 - (optional) LIMIT THE PARTICLES TO STAY ON SCREEN
-        //we could also pass in bounds to check - or alternatively do this at the WaterfallGameSource level
-        if( tmpAtom->pos.x > screenWidth - tmpAtom->scale*20 && tmpAtom->isDead == 0){
-            tmpAtom->pos.x = screenWidth - tmpAtom->scale*20;
-            tmpAtom->vel.x *= -1;
-        }else if( tmpAtom->pos.x < waterFallAreaX && tmpAtom->isDead == 0 ){
-            tmpAtom->pos.x = waterFallAreaX;
-            tmpAtom->vel.x *= -1;
-        }
-        if( tmpAtom->pos.y > screenHeight - tmpAtom->scale*20 && tmpAtom->isDead == 0){
-            tmpAtom->pos.y = screenHeight - tmpAtom ->scale*20;
-            tmpAtom->vel.y *= -1;
-        }
-        else if( tmpAtom->pos.y < tmpAtom->scale*20 && tmpAtom->isDead == 0){
-            tmpAtom->pos.y = tmpAtom->scale*20;
-            tmpAtom->vel.y *= -1;
+    TRACE_ZONE("WaterfallGameSource::updateAtoms");
+    // the force model is picked once for all atoms
+    if( atomState == 0 ){
+        islandField.set(0, myMouse.x, myMouse.y);
+        islandField.build();
+        atoms.force.time = TimerWheel::instance()->nowf();
+        atoms.update();
+    } else if(atomState == 1){
+        shockField.clear();
+        shockField.add(myMouse.x, myMouse.y, 200, 0.05);
+        shockField.build();
+        atomShock.caught = 0;
+        atoms.update(atomShock);
+        caughtCount += atomShock.caught;
+
+        if(caughtCount >= 10){
+            endGame = true;
         }
     }
 }
+// The shock pulls the atoms in for shockTotalTime, holding the button
+// longer doesn't extend it
+void WaterfallGameSource:: startShock(){
+    if(atomState == 1) return;
+    atomState = 1;
+    shockTimer = TimerWheel::instance()->schedule(shockTotalTime, [this](){ atomState = 0; });
+}
 void WaterfallGameSource:: updateIslandRings(){
     ringPhase+=3;
 
     vel *= drag;
-    frc.x = ofSignedNoise(cos(myMouse.y * 0.1), ofGetElapsedTimef()*0.2);
-    frc.y = ofSignedNoise(sin(myMouse.x * 0.1), ofGetElapsedTimef()*0.2);
+    float time = TimerWheel::instance()->nowf();
+    frc.x = ofSignedNoise(cos(myMouse.y * 0.1), time*0.2);
+    frc.y = ofSignedNoise(sin(myMouse.x * 0.1), time*0.2);
     vel += frc*0.6;
     myMouse += vel;
 
@@ -453,18 +312,39 @@ void WaterfallGameSource:: updateIslandRings(){
     }
 }
 //---------------------------------------------------------------
+// What glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), the alpha blending
+// of openFrameworks, leaves of src drawn over dst, alpha channel included
+static ofFloatColor blendOver(const ofFloatColor & src, const ofFloatColor & dst){
+    float a = src.a;
+    return ofFloatColor(src.r * a + dst.r * (1 - a), src.g * a + dst.g * (1 - a),
+                        src.b * a + dst.b * (1 - a), src.a * a + dst.a * (1 - a));
+}
+//---------------------------------------------------------------
 // Main Draw
+// Alpha blending is set once for the particles. With reducedFill the
+// background is a clear to the colour the blended quad used to leave, and
+// the rings, the only opaque geometry, come last with blending off: they
+// have to cover the particles, so they cannot go first without a depth
+// buffer. Compare the two with DrawStats (key -) and GoldenFrames.
 void WaterfallGameSource::draw(){
-    ofClear(0); //clear the buffer
-    //background
-    ofPushStyle();
-    ofSetColor(water);
-    ofDrawRectangle(0, 0,screenWidth, screenHeight );
-    ofPopStyle();
+    TRACE_ZONE("WaterfallGameSource::draw");
+    DrawStatsScope drawStats(name);
+    // nothing set in here outlives the draw, the other sources share the renderer
+    counted::ofPushStyle();
+    counted::ofEnableAlphaBlending();
+    if(config.reducedFill){
+        ofFloatColor background = blendOver(water, ofFloatColor(0, 0, 0, 0));
+        ofClear(background.r * 255, background.g * 255, background.b * 255, background.a * 255);
+    } else {
+        ofClear(0); //clear the buffer
+        //background
+        counted::ofSetColor(water);
+        counted::ofDrawRectangle(0, 0,screenWidth, screenHeight );
+    }
     // draw objects
     drawGenField();
     drawWaterfall();
-    drawAtoms(r1, r2);
+    drawAtoms();
     // FPS readout
    // ofSetColor(230);
    // string fpsStr = "frame rate: "+ofToString(ofGetFrameRate(), 2);
@@ -474,176 +354,290 @@ void WaterfallGameSource::draw(){
         drawIslandRings();
         // game ended restart msg
     } else if (endGame == true){
-        ofPushMatrix();
-        ofPushStyle();
+        counted::ofPushMatrix();
+        counted::ofPushStyle();
         ofSetDrawBitmapMode(OF_BITMAPMODE_MODEL);
         string replayStr = "Press Button To Replay";
-        ofTranslate(fieldCentreX, screenHeight/2);
-        ofRotate(-90);
-        ofScale(1.5,1.5);
-        ofDrawBitmapStringHighlight(replayStr,-100,0,ofColor(255),ofColor(0));
-        ofSetColor(255);
-        ofPopStyle();
-        ofPopMatrix();
+        counted::ofTranslate(fieldCentreX, screenHeight/2);
+        counted::ofRotate(-90);
+        counted::ofScale(1.5,1.5);
+        counted::ofDrawBitmapStringHighlight(replayStr,-100,0,ofColor(255),ofColor(0));
+        counted::ofSetColor(255);
+        counted::ofPopStyle();
+        counted::ofPopMatrix();
     }
+    counted::ofPopStyle();
 }
 //---------------------------------------------------------------
 // Draw functions for all game objects
 void WaterfallGameSource::drawGenField(){
-    ofPushMatrix();
-    ofPushStyle();
-    ofEnableAlphaBlending();
-    lineMesh.draw();
-    ofDisableAlphaBlending();
-    ofPopStyle();
-    ofPopMatrix();
+    TRACE_ZONE("WaterfallGameSource::drawGenField");
+    genField.draw();
 }
 void WaterfallGameSource::drawWaterfall(){
+    TRACE_ZONE("WaterfallGameSource::drawWaterfall");
+    waterfall.renderer.setEnded(endGame);
+    waterfall.draw();
+}
+void WaterfallGameSource:: drawAtoms(){
+    TRACE_ZONE("WaterfallGameSource::drawAtoms");
+    atoms.renderer.c1 = atomPalette.getColor(0);
+    atoms.renderer.c2 = atomPalette.getColor(1);
+    atoms.draw();
+}
+void WaterfallGameSource:: cancelTimers(){
+    TimerWheel * wheel = TimerWheel::instance();
+    wheel->cancel(gameTimer);
+    wheel->cancel(shockTimer);
+}
+//--------------------------------------------------------------
+// Attract mode
+void WaterfallGameSource::noteActivity(){
+    TimerWheel * wheel = TimerWheel::instance();
+    wheel->cancel(idleTimer);
+    idleTimer = wheel->schedule(config.idleTimeout, [this](){ enterAttract(); });
+}
+// Fewer particles at a slower tick, still moving so the station draws people in
+void WaterfallGameSource::enterAttract(){
+    if(attract) return;
+    attract = true;
+    applyTickRate();
+    applyPoolSizes();
+    load.setMode(1);
+    logNotice("{}: attract mode after {}s without play, {}", name, config.idleTimeout / 1000, load.getStatsString());
+}
+void WaterfallGameSource::leaveAttract(){
+    if(!attract) return;
+    attract = false;
+    applyTickRate();
+    applyPoolSizes();
+    // one full rate step right away, it takes the press that woke us
+    lastTick = TimerWheel::instance()->now() - (uint64_t)(tickSeconds * 1000);
+    load.setMode(0);
+    noteActivity();
+    logNotice("{}: playing, {}", name, load.getStatsString());
+}
+bool WaterfallGameSource::isAttracting(){
+    return attract;
+}
+string WaterfallGameSource::getLoadString(){
+    return name + ": " + load.getStatsString();
+}
+//--------------------------------------------------------------
+// Snapshot and resume
 
-    for (unsigned int i = 0; i < drops.size(); i++){
-        Drop* tmpDrop = drops.at(i);
+// millis left on a timer, -1 when it is not running
+static int32_t remainingMillis(TimerWheel::TimerId id){
+    TimerWheel * wheel = TimerWheel::instance();
+    if(!wheel->isScheduled(id)) return -1;
+    return MAX(0, (int64_t)wheel->getExpiry(id) - (int64_t)wheel->now());
+}
 
-        if(tmpDrop->pos.x > 0 && tmpDrop->pos.x < waterFallAreaX){
-            ofPushStyle();
-            if(endGame == false) ofSetColor(100,220,255,60);
-            else if(endGame == true) ofSetColor(0,200,255,60);
-            ofDrawLine(tmpDrop->pos.x - 50,tmpDrop->pos.y + 10,tmpDrop->pos.x + 50, tmpDrop->pos.y + 10);
-            ofDrawLine(tmpDrop->pos.x - 50,tmpDrop->pos.y - 10,tmpDrop->pos.x + 50, tmpDrop->pos.y - 10);
-            ofPopStyle();
-        }
-        ofPushStyle();
-        float alpha = ofMap(tmpDrop->lifespan, 100,0,255,0);
-        if(endGame == false) ofSetColor(0,255,200,alpha);
-        else if(endGame == true)ofSetColor(255,255,255,alpha);
-        ofDrawEllipse( tmpDrop->pos.x, tmpDrop->pos.y, tmpDrop->scale * 12, tmpDrop->scale * 12);
-        ofPopStyle();
-
-        ofPushStyle();
-        if(endGame == false) ofSetColor(0,255,255,alpha);
-        else if(endGame == true) ofSetColor(0,190,255,alpha);
-        ofDrawEllipse( tmpDrop->pos.x, tmpDrop->pos.y, tmpDrop->scale * 10, tmpDrop->scale * 10);
-        ofPopStyle();
-    }
+void WaterfallGameSource::saveState(SnapshotWriter & out){
+    uint64_t now = TimerWheel::instance()->now();
+    out.beginSection(name);
+    out.write((int32_t)caughtCount);
+    out.write((int32_t)buttonHits);
+    out.write((int32_t)atomState);
+    out.write((uint8_t)endGame);
+    out.write((uint8_t)gameTimedOut);
+    out.write((uint8_t)attract);
+    out.write(remainingMillis(gameTimer));
+    out.write(remainingMillis(shockTimer));
+    out.write(remainingMillis(idleTimer));
+    out.write((int32_t)atomPalette.getCycleElapsed(now));
+    out.write((int32_t)islePalette.getCycleElapsed(now));
+    out.write(ringPhase);
+    out.write(myMouse);
+    out.write(vel);
+    out.writeArray(genField.data(), genField.size());
+    out.write((int32_t)genField.alive());
+    out.writeArray(waterfall.data(), waterfall.size());
+    out.write((int32_t)waterfall.alive());
+    out.writeArray(atoms.data(), atoms.size());
+    out.write((int32_t)atoms.alive());
+    out.endSection();
 }
-void WaterfallGameSource:: drawAtoms(ofColor r1, ofColor r2){
-    int timer1 = ofRandom(500,1000);
-    int timer2 = ofRandom(1500,2000);
-    int timer3 = ofRandom(2500,3000);
-    int timer4 = ofRandom(4000,4500);
-    int timer5 = ofRandom(5000,6000);
-
-    if(ofGetElapsedTimeMillis() - atomStartTime < timer1){
-        r1 = ofColor(50, 250, 50);
-        r2 = ofColor(200, 50, 255);
-        atomRed = false;
-    }else if(ofGetElapsedTimeMillis() - atomStartTime < timer2){
-        r1 = ofColor(80, 150, 250);
-        r2 = ofColor(50, 180, 100);
-    }else if(ofGetElapsedTimeMillis() - atomStartTime < timer3){
-        r1 = ofColor(130, 150, 220);
-        r2 = ofColor(100, 255, 150);
-    }else if(ofGetElapsedTimeMillis() - atomStartTime < timer4){
-        atomRed = true;
-        r1 = ofColor(255, 50, 50);
-        r2 = ofColor(200, 255, 50);
-
-    } else if(ofGetElapsedTimeMillis() - atomStartTime < timer5){
-
-        atomStartTime = ofGetElapsedTimeMillis();
+
+// Everything is read before anything is changed, a snapshot of another
+// build or another station size leaves the fresh game alone
+bool WaterfallGameSource::restoreState(SnapshotReader & in){
+    int32_t savedCaught, savedHits, savedAtomState, gameLeft, shockLeft, idleLeft, atomElapsed, isleElapsed;
+    int32_t fieldAlive, dropsAlive, atomsAlive;
+    uint8_t savedEndGame, savedTimedOut, savedAttract;
+    float savedRingPhase;
+    ofPoint savedMouse, savedVel;
+    vector<Particle> field;
+    vector<Drop> drops;
+    vector<atomParticle> savedAtoms;
+    bool ok = in.section(name)
+        && in.read(savedCaught) && in.read(savedHits) && in.read(savedAtomState)
+        && in.read(savedEndGame) && in.read(savedTimedOut) && in.read(savedAttract)
+        && in.read(gameLeft) && in.read(shockLeft) && in.read(idleLeft)
+        && in.read(atomElapsed) && in.read(isleElapsed)
+        && in.read(savedRingPhase) && in.read(savedMouse) && in.read(savedVel)
+        && in.readArray(field) && in.read(fieldAlive)
+        && in.readArray(drops) && in.read(dropsAlive)
+        && in.readArray(savedAtoms) && in.read(atomsAlive);
+    if(!ok){
+        logWarning("{}: no usable snapshot, starting a new game", name);
+        return false;
     }
-    for (unsigned int i = 0; i < atoms.size(); i++){
 
-        atomParticle* tmpAtom = atoms.at(i);
-        atom(tmpAtom->pos.x, tmpAtom->pos.y, tmpAtom->scale,tmpAtom->phase, r1, r2);
+    TimerWheel * wheel = TimerWheel::instance();
+    uint64_t now = wheel->now();
+    cancelTimers();
+    caughtCount = savedCaught;
+    buttonHits = savedHits;
+    atomState = savedAtomState;
+    endGame = savedEndGame;
+    gameTimedOut = savedTimedOut;
+    if(gameLeft >= 0) gameTimer = wheel->schedule(gameLeft, [this](){ gameTimedOut = true; });
+    if(atomState == 1) shockTimer = wheel->schedule(MAX(0, shockLeft), [this](){ atomState = 0; });
+    atomPalette.resume(now, atomElapsed);
+    islePalette.resume(now, isleElapsed);
+    ringPhase = savedRingPhase;
+    myMouse = savedMouse;
+    vel = savedVel;
+
+    // the pools come back as they were, then take the sizes of the current config
+    genField.particles.swap(field);
+    genField.numAlive = MIN(fieldAlive, genField.size());
+    waterfall.particles.swap(drops);
+    waterfall.numAlive = MIN(dropsAlive, waterfall.size());
+    atoms.particles.swap(savedAtoms);
+    atoms.numAlive = MIN(atomsAlive, atoms.size());
+    if(atoms.size() != config.atoms) atoms.resize(config.atoms);
+
+    lastCaughtCount = caughtCount;
+    lastEndGame = endGame;
+    lastTick = now;
+    if(savedAttract){
+        wheel->cancel(idleTimer);
+        enterAttract();
+    } else {
+        applyPoolSizes();
+        wheel->cancel(idleTimer);
+        idleTimer = wheel->schedule(idleLeft >= 0 ? idleLeft : config.idleTimeout, [this](){ enterAttract(); });
     }
+    logNotice("{}: resumed a game with {} caught{}", name, caughtCount, attract ? ", in attract mode" : "");
+    return true;
+}
+
+// The game timers kept their remaining time on the wheel, the tick and
+// the colour cycles carry on where they were
+void WaterfallGameSource::rebase(int64_t delta){
+    uint64_t now = TimerWheel::instance()->now();
+    lastTick += delta;
+    atomPalette.resume(now, atomPalette.getCycleElapsed(now - delta));
+    islePalette.resume(now, islePalette.getCycleElapsed(now - delta));
+}
+
+//--------------------------------------------------------------
+// Runtime parameters, the game times are picked up by the next game
+void WaterfallGameSource::addParameters(){
+    Settings * settings = Settings::instance();
+    settings->addParameter(name + ":particles", &config.fieldParticles, 0, 2000, [this](){ applyPoolSizes(); });
+    settings->addParameter(name + ":drops", &config.drops, 0, 2000, [this](){ applyPoolSizes(); });
+    settings->addParameter(name + ":atoms", &config.atoms, 1, 100, [this](){ atoms.resize(config.atoms); });
+    settings->addParameter(name + ":grid", &config.gridResolution, 1, 100, [this](){ applyGrid(); });
+    settings->addParameter(name + ":lineDistance", &config.lineDistance, 0, 400, [this](){ genField.renderer.maxDistance = config.lineDistance; });
+    settings->addParameter(name + ":tickRate", &config.tickRate, 1, 120, [this](){ applyTickRate(); });
+    settings->addParameter(name + ":gameTime", &config.gameTotalTime, 1000, 3600000);
+    settings->addParameter(name + ":shockTime", &config.shockTotalTime, 0, 60000);
+    settings->addParameter(name + ":idleTimeout", &config.idleTimeout, 1000, 86400000, [this](){ noteActivity(); });
+    settings->addParameter(name + ":attractTickRate", &config.attractTickRate, 1, 120, [this](){ applyTickRate(); });
+    settings->addParameter(name + ":attractDensity", &config.attractDensity, 0, 1, [this](){ applyPoolSizes(); });
+    settings->addParameter(name + ":reducedFill", &config.reducedFill);
+}
+// Resizing keeps the particles that stay, so nothing jumps on screen
+void WaterfallGameSource::applyPoolSizes(){
+    float density = attract ? config.attractDensity : 1;
+    genField.resize(MAX(1, config.fieldParticles * density));
+    waterfall.resize(MAX(1, config.drops * density));
+}
+void WaterfallGameSource::applyTickRate(){
+    tickSeconds = 1.0 / MAX(1, attract ? config.attractTickRate : config.tickRate);
+}
+void WaterfallGameSource::applyGrid(){
+    genField.renderer.setup(&area, config.gridResolution, config.gridResolution);
+    genField.renderer.maxDistance = config.lineDistance;
 }
 void WaterfallGameSource:: drawIslandRings(){
+    TRACE_ZONE("WaterfallGameSource::drawIslandRings");
     int numOfCircles = 6;
     int ringSpacing = 6;
     float cycles = 180;
     float phaseSpacing = cycles / numOfCircles;
 
-    if(ofGetElapsedTimeMillis() - isleStartTime < 1500){
-        isleC1 = ofColor(80, 150, 150);
-        isleC2 = ofColor(50, 180, 90);
-        isleRed = false;
-    }else if(ofGetElapsedTimeMillis() - isleStartTime < 2500){
-        isleC1 = ofColor(130, 150, 120);
-        isleC2 = ofColor(100, 205, 150);
-    }else if(ofGetElapsedTimeMillis() - isleStartTime < 3500){
-        isleC1 = ofColor(80, 150, 150);
-        isleC2 = ofColor(50, 180, 90);
-    }else if(ofGetElapsedTimeMillis() - isleStartTime < 6500){
-        isleRed = true;
-        isleC1 = ofColor(255, 50, 50);
-        isleC2 = ofColor(255, 100, 100);
-
-    } else if(ofGetElapsedTimeMillis() - isleStartTime < 7500){
-
-        isleStartTime = ofGetElapsedTimeMillis();
+    if(config.reducedFill && buildIslandRings(numOfCircles, ringSpacing, phaseSpacing)){
+        // every pixel of the island is shaded once, blending stays off until the style is popped
+        counted::ofDisableAlphaBlending();
+        counted::ofPushMatrix();
+        counted::ofTranslate(myMouse.x, myMouse.y);
+        counted::draw(ringMesh);
+        counted::ofPopMatrix();
+        return;
     }
-
     for (int i = numOfCircles; i > 0; i--) {
-        ofColor c = isleC1.getLerped(isleC2, ofMap(i, 0, numOfCircles*2, 0, 1));
-        ring(myMouse.x, myMouse.y, i*ringSpacing, ringPhase + phaseSpacing * i, c);
+        ring(myMouse.x, myMouse.y, i*ringSpacing, ringPhase + phaseSpacing * i, islePalette.getColor(i - 1));
     }
 }
-//--------------------------------------------------------------
-// play pieces
-void WaterfallGameSource:: atom(float posX, float posY, float r, float p, ofColor c1, ofColor c2) {
-    int numOfRings = 2;
-    float phaseDiff = 180 / numOfRings;
-
-    for (int rings = 0; rings < numOfRings; rings++) {
-        float oscillation = 100;
-        p = p + rings * phaseDiff;
-        float localPhaseY = p * ofMap(cos(oscillation ), -1, 1, 0.5, 2);
-        float localPhaseX = p * ofMap(sin(oscillation ), -1, 1, 0.5, 2);
-
-        ofPushStyle();
-        ofNoFill();
-        ofSetLineWidth(4);
-
-        ofPushMatrix();
-        ofTranslate(posX, posY);
-        ofRotateX(localPhaseX);
-        ofSetColor(c1);
-        ofDrawCircle(0, 0, r* 20);
-        ofSetColor(255);
-        ofSetLineWidth(1);
-        ofDrawCircle(0, 0, r* 20.5);
-        ofPopMatrix();
-        ofPopStyle();
-
-        ofPushStyle();
-        ofNoFill();
-        ofSetLineWidth(4);
-
-        ofPushMatrix();
-        ofTranslate(posX, posY);
-        ofRotateY(localPhaseY);
-        ofSetColor(c2);
-        ofDrawCircle(0, 0, r* 5);
-        ofSetColor(0);
-        ofFill();
-        ofDrawCircle(0, 0, r* 3);
-        ofPopMatrix();
-        ofPopStyle();
+// The rings as the annuli they look like. Each ring shows its colour
+// between its inner disc and its edge, and the water tinted inner disc
+// down to the next smaller ring. That tint is mixed here instead of
+// blended. Nothing overlaps, so the mesh is drawn opaque. A palette with
+// translucent colours falls back to the discs.
+bool WaterfallGameSource::buildIslandRings(int count, float spacing, float phaseSpacing){
+    ringMesh.clear();
+    ringMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    ofFloatColor tint = water;
+    for (int i = count; i > 0; i--) {
+        ofFloatColor color = islePalette.getColor(i - 1);
+        if(color.a < 1) return false;
+        float r = i * spacing;
+        float radDiff = ofMap(sin(ofDegToRad(ringPhase + phaseSpacing * i)), -1, 1, 1, 6);
+        float covered = (i - 1) * spacing; // by the next ring, drawn over this one
+        float inner = MAX(covered, r - radDiff);
+        addRingBand(inner, r, color);
+        addRingBand(covered, inner, blendOver(tint, color));
     }
-
+    return true;
 }
+void WaterfallGameSource::addRingBand(float inner, float outer, const ofFloatColor & color){
+    if(outer <= inner) return;
+    const vector<ofVec2f> & unit = geometry->ringOutline;
+    int segments = unit.size() - 1;
+    ofIndexType base = ringMesh.getNumVertices();
+    for(int s = 0; s <= segments; s++){
+        ringMesh.addVertex(ofVec3f(unit[s].x * inner, unit[s].y * inner, 0));
+        ringMesh.addVertex(ofVec3f(unit[s].x * outer, unit[s].y * outer, 0));
+        ringMesh.addColor(color);
+        ringMesh.addColor(color);
+    }
+    for(int s = 0; s < segments; s++){
+        ofIndexType a = base + s * 2;
+        ringMesh.addTriangle(a, a + 1, a + 3);
+        ringMesh.addTriangle(a, a + 3, a + 2);
+    }
+}
+//--------------------------------------------------------------
+// play pieces
 void WaterfallGameSource:: ring(float posX, float posY, float r, float p, ofColor color) {
-    ofPushMatrix();
-    ofPushStyle();
-    ofSetCircleResolution(100);
-    ofTranslate(posX, posY);
-    ofSetColor(color);
-    ofDrawCircle(0, 0, r);
+    counted::ofPushMatrix();
+    counted::ofPushStyle();
+    counted::ofTranslate(posX, posY);
+    counted::ofSetColor(color);
+    counted::ofPushMatrix();
+    counted::ofScale(r, r);
+    counted::draw(geometry->ringDisk);
+    counted::ofPopMatrix();
     float radDiff = ofMap(sin(ofDegToRad(p)),-1, 1, 1, 6);
-    ofSetColor(water);
-    ofDrawCircle(0, 0, r - radDiff);
-    ofPopMatrix();
-    ofPopStyle();
+    counted::ofSetColor(water);
+    counted::ofScale(r - radDiff, r - radDiff);
+    counted::draw(geometry->ringDisk);
+    counted::ofPopStyle();
+    counted::ofPopMatrix();
 
 }
 
@@ -2,67 +2,55 @@
 
 #include "ofMain.h"
 #include "FboSource.h"
+#include "Trace.h"
+#include "DrawStats.h"
 #include "ofxGPIO.h"
-
-class Particle
-{
-public:
-
-    ofVec2f pos;
-    ofVec2f vel;
-
-    int myID;
-
-    int spacePartitioningIndexX;
-    int spacePartitioningIndexY;
-};
-
-class Drop{
-public:
-    ofPoint pos, frc;
-    ofVec2f vel;
-    float uniqueVal;
-    int lifespan = 150;
-    float drag;
-    float windY;
-    float scale;
-};
-
-class atomParticle{
-public:
-    atomParticle(){
-        attractPoints = NULL;
-    }
-
-    void setAttractPoints( vector <ofPoint> * attract ){
-        attractPoints = attract;
-    }
-    ofPoint pos;
-    ofPoint vel;
-    ofPoint frc;
-    float isDead;
-
-
-    float drag;
-    float uniqueVal;
-    float scale;
-    float phase;
-    float pSpeed;
-
-
-
-    vector <ofPoint> * attractPoints;
-
+#include "WaterfallParticles.h"
+#include "TimerWheel.h"
+#include "PaletteTimeline.h"
+#include "LoadMeter.h"
+#include "AsyncLog.h"
+#include "StateSnapshot.h"
+#include "InputLog.h"
+
+// Everything that differs between game stations running side by side
+struct WaterfallGameConfig {
+    WaterfallGameConfig();
+
+    string name;
+    string gpioPin;         // the station's button
+    int width, height;      // fbo size
+    int fieldParticles;
+    int drops;
+    int atoms;
+    int gridResolution;     // cells per side of the line field grid
+    float lineDistance;     // longest line between field particles
+    int gameTotalTime;      // millis until an unfinished game is reset
+    int shockTotalTime;     // millis the atoms are pulled in after a hit
+    float tickRate;         // simulation steps per second
+
+    // attract mode, entered when nobody has played for idleTimeout millis
+    int idleTimeout;
+    float attractTickRate;
+    float attractDensity;   // share of field particles and drops kept
+
+    // fill rate: clear to the background colour instead of blending a
+    // quad over the FBO, and draw the island rings as opaque annuli
+    // instead of overdrawn discs, see WaterfallGameSource::draw()
+    bool reducedFill;
 };
 
 class WaterfallGameSource : public ofx::piMapper::FboSource {
 public:
+    WaterfallGameSource();
+    ~WaterfallGameSource();
     void setup();
+    void setup(const WaterfallGameConfig & _config);
     void update();
+    void tick();
     void draw();
     void setName(string _name);
     void gameReset();
-    void atom(float posX, float posY, float r, float p, ofColor c1, ofColor c2);
     void ring(float posX, float posY, float r, float p, ofColor color);
 
     void resetParticles();
@@ -77,11 +65,51 @@ public:
 
     void setupAtoms();
     void updateAtoms();
-    void drawAtoms(ofColor r1, ofColor r2);
+    void drawAtoms();
+    void startShock();
+    void readButton();
 
     void setupIslandRings();
     void updateIslandRings();
     void drawIslandRings();
+    bool buildIslandRings(int count, float spacing, float phaseSpacing);
+    void addRingBand(float inner, float outer, const ofFloatColor & color);
+
+    void cancelTimers();
+
+    // Runtime parameters under "<name>:...", see Settings
+    void addParameters();
+    void applyPoolSizes();
+    void applyTickRate();
+    void applyGrid();
+
+    // Attract mode: the first press brings back full quality at once
+    void noteActivity();
+    void enterAttract();
+    void leaveAttract();
+    bool isAttracting();
+    string getLoadString();
+
+    // The running game and the particles, under the source name, see StateSnapshot
+    void saveState(SnapshotWriter & out);
+    bool restoreState(SnapshotReader & in);
+    // the clock was stepped by delta millis, see TimerWheel::rebase()
+    void rebase(int64_t delta);
+
+    WaterfallGameConfig config;
+    // read-only meshes shared with the other stations
+    std::shared_ptr<WaterfallGeometry> geometry;
+
+    // the simulation runs at config.tickRate whatever the frame rate
+    uint64_t lastTick;
+    float tickSeconds;
+
+    // any press or change of the game state restarts the idle timer
+    TimerWheel::TimerId idleTimer;
+    bool attract;
+    int lastCaughtCount;
+    bool lastEndGame;
+    LoadMeter load;
 
     float screenWidth;
     float screenHeight;
@@ -94,55 +122,45 @@ public:
     bool endGame;
     ofColor water;
 
-    float gameSavedTime;
+    // Game and shock timers run on the shared timer wheel
+    TimerWheel::TimerId gameTimer, shockTimer;
+    bool gameTimedOut;
     float gameTotalTime;
 
-    // GenField
-    float currTime, timeDelta, lastUpdateTime;
-    vector< Particle* > particles;
-
-    vector< vector< vector< Particle* > > > spacePartitioningGrid;
+    WaterfallArea area;
 
-    int					spacePartitioningResX;
-    int					spacePartitioningResY;
-    float				spacePartitioningGridWidth;
-    float				spacePartitioningGridHeight;
-
-    ofMesh				lineMesh;
+    // GenField
+    GenFieldSystem genField;
 
     // Waterfall
-    vector< Drop* > drops;
+    WaterfallSystem waterfall;
 
     //Atoms
+    // Colour cycles from palettes.json, the red keyframes are flagged
+    PaletteTimeline atomPalette, islePalette;
     bool atomRed;
     bool isleRed;
     int atomState;
 
-    vector<atomParticle* > atoms;
+    AtomSystem atoms;
+    AtomShockForce atomShock;
 
-    vector<float> posX, posY;
+    // The island rings repel wandering atoms, a shocked island pulls them in
+    ForceField islandField;
+    ForceField shockField;
 
-    vector <ofPoint> attractPoints;
-    vector <ofPoint> attractPointsWithMovement;
-
-    float atomStartTime;
-
-    float shockSavedTime;
     float shockTotalTime;
 
-    ofColor r1, r2;
-
     //IslandRings
-    float isleStartTime;
     float ringPhase;
-    ofColor isleC1, isleC2;
+    ofMesh ringMesh;    // reducedFill: every band of every ring, rebuilt each frame
     ofPoint myMouse;
     ofPoint vel;
     ofPoint frc;
     float drag;
 
     // Pinouts
-    GPIO gpio17;
+    GPIO button;
     string state_button;
 
 };
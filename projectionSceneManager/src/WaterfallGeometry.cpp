@@ -0,0 +1,44 @@
+#include "WaterfallGeometry.h"
+
+static WaterfallGeometry * createWaterfallGeometry(){
+    WaterfallGeometry * geometry = new WaterfallGeometry();
+    WaterfallGeometry::buildDisk(geometry->ringDisk, 100);
+    WaterfallGeometry::buildDisk(geometry->atomDisk, 20);
+    WaterfallGeometry::buildCircle(geometry->atomCircle, 20);
+    // the same edge as ringDisk
+    WaterfallGeometry::buildOutline(geometry->ringOutline, 100);
+    return geometry;
+}
+
+std::shared_ptr<WaterfallGeometry> WaterfallGeometry::acquire(){
+    return ResourceCache<WaterfallGeometry>::get("waterfall", createWaterfallGeometry);
+}
+
+void WaterfallGeometry::buildDisk(ofVboMesh & mesh, int segments){
+    mesh.clear();
+    mesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+    mesh.setUsage(GL_STATIC_DRAW);
+    mesh.addVertex(ofVec3f(0, 0, 0));
+    for(int i = 0; i <= segments; i++){
+        float angle = TWO_PI * i / segments;
+        mesh.addVertex(ofVec3f(cos(angle), sin(angle), 0));
+    }
+}
+
+void WaterfallGeometry::buildCircle(ofVboMesh & mesh, int segments){
+    mesh.clear();
+    mesh.setMode(OF_PRIMITIVE_LINE_LOOP);
+    mesh.setUsage(GL_STATIC_DRAW);
+    for(int i = 0; i < segments; i++){
+        float angle = TWO_PI * i / segments;
+        mesh.addVertex(ofVec3f(cos(angle), sin(angle), 0));
+    }
+}
+
+void WaterfallGeometry::buildOutline(vector<ofVec2f> & points, int segments){
+    points.clear();
+    for(int i = 0; i <= segments; i++){
+        float angle = TWO_PI * i / segments;
+        points.push_back(ofVec2f(cos(angle), sin(angle)));
+    }
+}
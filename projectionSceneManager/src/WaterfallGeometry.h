@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ResourceCache.h"
+
+// Unit meshes the WaterfallGameSource renderers scale into place. They
+// carry their own resolution, so drawing never depends on (or changes)
+// the global circle resolution, and one copy is shared by all game
+// instances through acquire().
+struct WaterfallGeometry {
+    ofVboMesh ringDisk;     // filled, 100 segments, island rings
+    ofVboMesh atomDisk;     // filled, 20 segments, atom cores and drops
+    ofVboMesh atomCircle;   // outline, 20 segments, atom orbits
+    vector<ofVec2f> ringOutline; // unit circle, 100 segments closed, for the annuli built every frame
+
+    static std::shared_ptr<WaterfallGeometry> acquire();
+
+    static void buildDisk(ofVboMesh & mesh, int segments);
+    static void buildCircle(ofVboMesh & mesh, int segments);
+    static void buildOutline(vector<ofVec2f> & points, int segments);
+};
@@ -0,0 +1,459 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "ForceField.h"
+#include "WaterfallGeometry.h"
+#include "DrawStats.h"
+
+// Particle types and policies of the three WaterfallGameSource effects:
+// the generative line field, the waterfall drops and the atoms.
+
+// Layout of the game area, shared by the policies of all effects
+struct WaterfallArea {
+    float width;
+    float height;
+    float offset;
+    float fallX;  // the waterfall occupies x < fallX ...
+    float fallY;  // ... between fallY and height - fallY
+};
+
+//--------------------------------------------------------------
+// GenField: drifting particles connected by lines when close
+
+struct Particle {
+    ofVec2f pos;
+    ofVec2f vel;
+
+    int myID;
+
+    int spacePartitioningIndexX;
+    int spacePartitioningIndexY;
+};
+
+struct FieldEmitter {
+    WaterfallArea * area;
+
+    void emit(Particle & p, int index){
+        p.pos.set(ofRandom(area->fallX, area->width), ofRandom(area->height));
+
+        float tmpAngle = ofRandom( PI * 2.0f );
+        float magnitude = 20.0f; // pixels per second
+        p.vel.set( cosf(tmpAngle) * magnitude, sinf(tmpAngle) * magnitude );
+
+        p.spacePartitioningIndexX = 0;
+        p.spacePartitioningIndexY = 0;
+        p.myID = index;
+    }
+};
+
+struct DriftForce {
+    float timeDelta;
+
+    bool step(Particle & p){
+        p.pos += p.vel * timeDelta;
+        return true;
+    }
+};
+
+// wraps around the field, which starts right of the waterfall
+struct FieldWrapBoundary {
+    WaterfallArea * area;
+
+    void apply(Particle & p){
+        p.pos.x = fmodf( p.pos.x, area->width );
+        if( p.pos.x < area->fallX ) p.pos.x += area->width;
+
+        p.pos.y = fmodf( p.pos.y, area->height );
+        if( p.pos.y < 0 ) p.pos.y += area->height;
+    }
+};
+
+struct LineConnectionRenderer {
+    int resX;
+    int resY;
+    float cellWidth;
+    float cellHeight;
+    float maxDistance;
+    ofFloatColor color;
+
+    vector< vector<int> > grid; // particle indices per cell, row major
+    ofMesh lineMesh;
+
+    void setup(WaterfallArea * area, int _resX, int _resY){
+        resX = _resX;
+        resY = _resY;
+        cellWidth = area->width / (float)resX;
+        cellHeight = area->height / (float)resY;
+        grid.assign(resX * resY, vector<int>());
+        maxDistance = 90;
+    }
+
+    // Rebuild the line mesh. To avoid checking every particle against every
+    // other particle, they are sorted into a grid first and only the cells
+    // within reach of the maximum line length are checked.
+    void connect(Particle * p, int count){
+        for(unsigned int c = 0; c < grid.size(); c++) grid[c].clear();
+
+        for(int i = 0; i < count; i++){
+            int tmpIndexX = ofClamp(p[i].pos.x / cellWidth, 0, resX - 1);
+            int tmpIndexY = ofClamp(p[i].pos.y / cellHeight, 0, resY - 1);
+            p[i].spacePartitioningIndexX = tmpIndexX;
+            p[i].spacePartitioningIndexY = tmpIndexY;
+            grid[tmpIndexY * resX + tmpIndexX].push_back(i);
+        }
+
+        lineMesh.clear();
+        lineMesh.setMode( OF_PRIMITIVE_LINES );
+        ofFloatColor scratchColor = color;
+        float maxDistanceSquared = maxDistance * maxDistance;
+
+        // how many slots do we need to check on each side?
+        int reachX = ceil(maxDistance / cellWidth);
+        int reachY = ceil(maxDistance / cellHeight);
+
+        for(int i = 0; i < count; i++){
+            int startX = ofClamp(p[i].spacePartitioningIndexX - reachX, 0, resX - 1);
+            int endX   = ofClamp(p[i].spacePartitioningIndexX + reachX, 0, resX - 1);
+            int startY = ofClamp(p[i].spacePartitioningIndexY - reachY, 0, resY - 1);
+            int endY   = ofClamp(p[i].spacePartitioningIndexY + reachY, 0, resY - 1);
+
+            for(int y = startY; y < endY; y++){
+                for(int x = startX; x < endX; x++){
+                    vector<int> & cell = grid[y * resX + x];
+                    for(unsigned int c = 0; c < cell.size(); c++){
+                        Particle & other = p[cell[c]];
+                        if(p[i].myID == other.myID) continue;
+
+                        ofVec2f diff = p[i].pos - other.pos;
+                        if(diff.lengthSquared() < maxDistanceSquared){
+                            scratchColor.a = 1.0f - (diff.length() / maxDistance);
+                            lineMesh.addVertex( p[i].pos );
+                            lineMesh.addColor( scratchColor );
+                            lineMesh.addVertex( other.pos );
+                            lineMesh.addColor( scratchColor );
+                            lineMesh.addIndex( lineMesh.getNumVertices() - 2 );
+                            lineMesh.addIndex( lineMesh.getNumVertices() - 1 );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // alpha blending is set once for the whole frame by the source
+    void draw(Particle *, int){
+        counted::draw(lineMesh);
+    }
+};
+
+//--------------------------------------------------------------
+// Waterfall: drops pushed across the waterfall by noise
+
+struct Drop {
+    ofPoint pos, frc;
+    ofVec2f vel;
+    float uniqueVal;
+    int lifespan;
+    float drag;
+    float windY;
+    float scale;
+};
+
+struct DropEmitter {
+    WaterfallArea * area;
+
+    void emit(Drop & d, int){
+        d.pos.set(ofRandom(0, area->fallX * 2), ofRandom(area->fallY, area->height - area->fallY));
+        d.vel.set(0, ofRandom(-0.5, 0.5));
+        d.frc = ofPoint(0, 0, 0);
+        d.scale = ofRandom(0.5, 1);
+        d.uniqueVal = ofRandom(-10000, 10000);
+        d.drag = 1;
+        d.windY = 0;
+        d.lifespan = 150;
+    }
+};
+
+struct WaterfallForce {
+    WaterfallArea * area;
+    float time;
+
+    bool step(Drop & d){
+        d.windY = ofSignedNoise(d.pos.y * 0.003, d.pos.x * 0.006, time * 0.3);
+        d.frc.y = d.windY * 0.01 + ofSignedNoise(d.uniqueVal, d.pos.x * 0.02) * 0.3;
+        d.frc.x = ofSignedNoise(d.uniqueVal, d.pos.y * 0.006, time * 0.2) * 0.09 + 0.18;
+        d.vel *= d.drag;
+        d.vel += d.frc * 0.4;
+        d.drag = ofRandom(0.99, 1.05);
+        d.uniqueVal = ofRandom(-10000, 10000);
+
+        //we do this so as to skip the bounds check for the bottom and make the particles go back across the screen
+        if( d.pos.x + d.vel.x > area->fallX + 20){
+            d.pos.y = ofRandom(area->fallY, area->height - area->fallY);
+            d.pos.x -= area->fallX + 20;
+            d.lifespan = 100;
+        }
+        d.pos += d.vel;
+        return true;
+    }
+};
+
+// walls of the waterfall channel and the slowdown before its edge
+struct WaterfallChannel {
+    WaterfallArea * area;
+
+    void apply(Drop & d){
+        float fallX = area->fallX;
+        float fallY = area->fallY;
+        float height = area->height;
+
+        if( d.pos.y > height - fallY && d.pos.x < fallX ){
+            d.pos.y = height - fallY;
+            d.vel.y *= -1.0;
+        }
+        else if( d.pos.y < fallY && d.pos.x < fallX ){
+            d.pos.y = fallY;
+            d.vel.y *= -1.0;
+        }
+        if( d.pos.y > height && d.pos.x < fallX*2 && d.pos.x > fallX ){
+            d.pos.y = height;
+            d.vel.y *= -1.0;
+        }
+        else if( d.pos.y < 0 && d.pos.x < fallX*2 && d.pos.x > fallX ){
+            d.pos.y = 0;
+            d.vel.y *= -1.0;
+        }
+        if( d.pos.x > area->offset && d.pos.x < fallX - 100 ){
+            d.drag = ofRandom(0.91, 0.93);
+            d.lifespan -= 7;
+        } else if( d.pos.x > fallX - 100 && d.pos.x < fallX + 20 ){
+            d.frc.y = d.windY * 0.04 + ofSignedNoise(d.uniqueVal, d.pos.x * 0.02) * 0.6;
+            d.vel += d.frc * 0.45;
+            d.drag = ofRandom(0.94, 0.96);
+            d.lifespan -= 8;
+        }
+    }
+};
+
+struct DropRenderer {
+    WaterfallArea * area;
+    WaterfallGeometry * geometry;
+    ofColor lineColor;
+    ofColor outerColor;
+    ofColor innerColor;
+
+    // pick the colours once per frame instead of per drop
+    void setEnded(bool ended){
+        lineColor  = ended ? ofColor(0, 200, 255, 60) : ofColor(100, 220, 255, 60);
+        outerColor = ended ? ofColor(255, 255, 255)   : ofColor(0, 255, 200);
+        innerColor = ended ? ofColor(0, 190, 255)     : ofColor(0, 255, 255);
+    }
+
+    // every drop sets its colours, the style is left to the source
+    void draw(Drop * d, int count){
+        for(int i = 0; i < count; i++){
+            if(d[i].pos.x > 0 && d[i].pos.x < area->fallX){
+                counted::ofSetColor(lineColor);
+                counted::ofDrawLine(d[i].pos.x - 50, d[i].pos.y + 10, d[i].pos.x + 50, d[i].pos.y + 10);
+                counted::ofDrawLine(d[i].pos.x - 50, d[i].pos.y - 10, d[i].pos.x + 50, d[i].pos.y - 10);
+            }
+            float alpha = ofMap(d[i].lifespan, 100, 0, 255, 0);
+
+            counted::ofPushMatrix();
+            counted::ofTranslate(d[i].pos.x, d[i].pos.y);
+            counted::ofScale(d[i].scale * 6, d[i].scale * 6);
+            counted::ofSetColor(outerColor, alpha);
+            counted::draw(geometry->atomDisk);
+            counted::ofScale(10 / 12.0, 10 / 12.0);
+            counted::ofSetColor(innerColor, alpha);
+            counted::draw(geometry->atomDisk);
+            counted::ofPopMatrix();
+        }
+    }
+};
+
+//--------------------------------------------------------------
+// Atoms: wander around the island ring until a shock pulls them in
+
+struct atomParticle {
+    ofPoint pos;
+    ofPoint vel;
+    ofPoint frc;
+
+    float drag;
+    float uniqueVal;
+    float scale;
+    float phase;
+    float pSpeed;
+};
+
+struct AtomEmitter {
+    WaterfallArea * area;
+
+    void emit(atomParticle & a, int index){
+        //the unique val allows us to set properties slightly differently for each particle
+        a.uniqueVal = ofRandom(-10000, 10000);
+        a.frc = ofPoint(0, 0, 0);
+        a.drag = ofRandom(0.98, 1);
+        a.scale = ofRandom(0.5, 1.0);
+        a.phase = 0;
+        a.pSpeed = ofRandom(-25, 25);
+        revive(a, index);
+    }
+
+    void revive(atomParticle & a, int){
+        a.pos.x = ofRandom(area->fallX, area->width);
+        a.pos.y = ofRandom(area->height);
+        a.vel.x = ofRandom(-3.9, 3.9);
+        a.vel.y = ofRandom(-3.9, 3.9);
+    }
+};
+
+// normal play: pushed away from the islands that are close, noise otherwise
+struct AtomWanderForce {
+    ForceField * islands;
+    float time;
+
+    bool step(atomParticle & a){
+        a.phase += a.pSpeed;
+        a.vel *= a.drag;
+
+        //only repel points close to an island, each island pushes with its own strength
+        bool near = false;
+        ofPoint push;
+        islands->forEachNear(a.pos.x, a.pos.y, 150, [&](ForceField::Attractor & island, float dx, float dy, float dist){
+            if(dist <= 0) return;
+            push.x += dx / dist * island.strength;
+            push.y += dy / dist * island.strength;
+            near = true;
+        });
+
+        if( near ){
+            a.frc = push;
+            a.vel += push;
+        }else{
+            //if the particles are not close to us, lets add a little bit of random movement using noise. this is where uniqueVal comes in handy.
+            a.frc.x = ofSignedNoise(a.uniqueVal, a.pos.y * 0.1, time * 0.2);
+            a.frc.y = ofSignedNoise(a.uniqueVal, a.pos.x * 0.1, time * 0.2);
+            a.vel += a.frc * 0.1;
+        }
+        a.pos += a.vel;
+        return true;
+    }
+};
+
+// after a successful button hit: atoms near a shocked island are pulled in
+// and caught, the capture test is a radius query on the shock field
+struct AtomShockForce {
+    ForceField * shocks;
+    int caught;
+
+    bool step(atomParticle & a){
+        a.phase += a.pSpeed;
+        a.vel.set(0, 0, 0);
+
+        float dist;
+        int nearest = shocks->nearest(a.pos.x, a.pos.y, 200, dist);
+        if( nearest >= 0 ){
+            ForceField::Attractor & shock = shocks->get(nearest);
+            a.frc.set(shock.x - a.pos.x, shock.y - a.pos.y);
+            if( dist < 100 ){
+                caught++;
+                return false;
+            }
+            a.vel += a.frc * shock.strength;
+        }
+        a.pos += a.vel;
+        return true;
+    }
+};
+
+struct AtomBoundary {
+    WaterfallArea * area;
+
+    void apply(atomParticle & a){
+        float margin = a.scale * 20;
+        if( a.pos.x > area->width - margin ){
+            a.pos.x = area->width - margin;
+            a.vel.x *= -1;
+        }else if( a.pos.x < area->fallX ){
+            a.pos.x = area->fallX;
+            a.vel.x *= -1;
+        }
+        if( a.pos.y > area->height - margin ){
+            a.pos.y = area->height - margin;
+            a.vel.y *= -1;
+        }
+        else if( a.pos.y < margin ){
+            a.pos.y = margin;
+            a.vel.y *= -1;
+        }
+    }
+};
+
+struct AtomRenderer {
+    WaterfallGeometry * geometry;
+    ofColor c1;
+    ofColor c2;
+
+    // one style for all atoms, the orbits are outlines and the cores meshes
+    void draw(atomParticle * a, int count){
+        counted::ofPushStyle();
+        counted::ofNoFill();
+        for(int i = 0; i < count; i++){
+            drawAtom(a[i].pos.x, a[i].pos.y, a[i].scale, a[i].phase);
+        }
+        counted::ofPopStyle();
+    }
+
+    void drawAtom(float posX, float posY, float r, float p){
+        int numOfRings = 2;
+        float phaseDiff = 180 / numOfRings;
+
+        for (int rings = 0; rings < numOfRings; rings++) {
+            float oscillation = 100;
+            p = p + rings * phaseDiff;
+            float localPhaseY = p * ofMap(cos(oscillation ), -1, 1, 0.5, 2);
+            float localPhaseX = p * ofMap(sin(oscillation ), -1, 1, 0.5, 2);
+
+            counted::ofSetLineWidth(4);
+
+            counted::ofPushMatrix();
+            counted::ofTranslate(posX, posY);
+            counted::ofRotateX(localPhaseX);
+            counted::ofSetColor(c1);
+            circle(r * 20);
+            counted::ofSetColor(255);
+            counted::ofSetLineWidth(1);
+            circle(r * 20.5);
+            counted::ofPopMatrix();
+
+            counted::ofSetLineWidth(4);
+
+            counted::ofPushMatrix();
+            counted::ofTranslate(posX, posY);
+            counted::ofRotateY(localPhaseY);
+            counted::ofSetColor(c2);
+            circle(r * 5);
+            counted::ofSetColor(0);
+            counted::ofPushMatrix();
+            counted::ofScale(r * 3, r * 3);
+            counted::draw(geometry->atomDisk);
+            counted::ofPopMatrix();
+            counted::ofPopMatrix();
+        }
+    }
+
+    // outline of the given radius around the current origin
+    void circle(float radius){
+        counted::ofPushMatrix();
+        counted::ofScale(radius, radius);
+        counted::draw(geometry->atomCircle);
+        counted::ofPopMatrix();
+    }
+};
+
+typedef ParticleSystem<Particle, DriftForce, FieldWrapBoundary, FieldEmitter, LineConnectionRenderer> GenFieldSystem;
+typedef ParticleSystem<Drop, WaterfallForce, WaterfallChannel, DropEmitter, DropRenderer> WaterfallSystem;
+typedef ParticleSystem<atomParticle, AtomWanderForce, AtomBoundary, AtomEmitter, AtomRenderer> AtomSystem;
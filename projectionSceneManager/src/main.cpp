@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include "Settings.h"
+#include "ForceField.h"
+#include "DrawStats.h"
+#include "InputLog.h"
 
 int main(int argc, char * argv[]){
     bool fullscreen = false;
@@ -11,12 +14,162 @@ int main(int argc, char * argv[]){
     for(int i = 0; i < arguments.size(); ++i){
         if(arguments.at(i) == "-f"){
             fullscreen = true;
-            break;
+        }
+        // cluster playback: --leader or --follower, optionally with
+        // --cluster-group <address>:<port>, --node-id <name> and on the
+        // leader --cluster-log <csv file> for the follower offsets
+        if(arguments.at(i) == "--leader"){
+            Settings::instance()->setClusterRole("leader");
+        }
+        if(arguments.at(i) == "--follower"){
+            Settings::instance()->setClusterRole("follower");
+        }
+        if(arguments.at(i) == "--cluster-group" && i + 1 < (int)arguments.size()){
+            vector<string> address = ofSplitString(arguments.at(++i), ":");
+            if(!address.empty()) Settings::instance()->setClusterGroup(address[0]);
+            if(address.size() > 1) Settings::instance()->setClusterPort(ofToInt(address[1]));
+        }
+        if(arguments.at(i) == "--node-id" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setClusterNodeId(arguments.at(++i));
+        }
+        if(arguments.at(i) == "--cluster-log" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setClusterLog(arguments.at(++i));
+        }
+        // udp port for remote cues, off unless given. Anyone who can reach
+        // the port can change the show, only open it on the show network.
+        if(arguments.at(i) == "--cue-port" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setCuePort(ofToInt(arguments.at(++i)));
+        }
+        // runtime parameters: --set "<source>:<parameter>=<value>", and the
+        // control socket, off unless a path is given with --param-socket
+        if(arguments.at(i) == "--set" && i + 1 < (int)arguments.size()){
+            string assignment = arguments.at(++i);
+            size_t equals = assignment.rfind('=');
+            if(equals != string::npos){
+                Settings::instance()->setParameterOverride(assignment.substr(0, equals), assignment.substr(equals + 1));
+            }
+        }
+        if(arguments.at(i) == "--param-socket" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setParameterSocket(arguments.at(++i));
+        }
+        // log draw calls and state changes per source, see DrawStats
+        if(arguments.at(i) == "--draw-stats"){
+            DrawStats::instance()->setEnabled(true);
+        }
+        // render rate while the preset shows nothing but idle game stations
+        if(arguments.at(i) == "--attract-fps" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setAttractFrameRate(ofToInt(arguments.at(++i)));
+        }
+        // another show's data folder, with its own ofxpimapper.xml and scenes.json
+        if(arguments.at(i) == "--data" && i + 1 < (int)arguments.size()){
+            ofSetDataPathRoot(ofFilePath::getAbsolutePath(arguments.at(++i), false));
+        }
+        // offscreen render benchmark over all presets, see RenderBenchmark:
+        // --bench-render <frames per preset> [--bench-warmup <frames>] [--bench-out <json file>]
+        if(arguments.at(i) == "--bench-render" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setBenchFrames(ofToInt(arguments.at(++i)));
+        }
+        if(arguments.at(i) == "--bench-warmup" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setBenchWarmupFrames(ofToInt(arguments.at(++i)));
+        }
+        if(arguments.at(i) == "--bench-out" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setBenchOut(arguments.at(++i));
+        }
+        // golden images of every source, see GoldenFrames:
+        // --golden-record <dir> or --golden-check <dir> [--golden-frames 30,120,300]
+        if(arguments.at(i) == "--golden-record" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setGoldenDirectory(arguments.at(++i));
+            Settings::instance()->setGoldenRecord(true);
+        }
+        if(arguments.at(i) == "--golden-check" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setGoldenDirectory(arguments.at(++i));
+            Settings::instance()->setGoldenRecord(false);
+        }
+        if(arguments.at(i) == "--golden-frames" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setGoldenFrames(arguments.at(++i));
+        }
+        // resume after a restart, see StateSnapshot, off unless --snapshot <file in data> is given,
+        // --snapshot-interval <millis> (0 writes none), --snapshot-max-age <seconds> (0 never resumes)
+        if(arguments.at(i) == "--snapshot" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setSnapshotPath(arguments.at(++i));
+        }
+        if(arguments.at(i) == "--snapshot-interval" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setSnapshotInterval(ofToInt(arguments.at(++i)));
+        }
+        if(arguments.at(i) == "--snapshot-max-age" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setSnapshotMaxAge(ofToInt(arguments.at(++i)));
+        }
+        // buttons and cues, see InputLog: --record-input <file> during a show, and
+        // --replay-input <file> [--replay-sessions <n>] [--replay-speed <steps per frame>]
+        // [--replay-report <csv file>] for a soak test, see SoakTest
+        if(arguments.at(i) == "--record-input" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setRecordInput(arguments.at(++i));
+        }
+        if(arguments.at(i) == "--replay-input" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setReplayInput(arguments.at(++i));
+        }
+        if(arguments.at(i) == "--replay-sessions" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setReplaySessions(ofToInt(arguments.at(++i)));
+        }
+        if(arguments.at(i) == "--replay-speed" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setReplaySpeed(ofToInt(arguments.at(++i)));
+        }
+        if(arguments.at(i) == "--replay-report" && i + 1 < (int)arguments.size()){
+            Settings::instance()->setReplayReport(arguments.at(++i));
+        }
+        // headless, no window is opened
+        if(arguments.at(i) == "--bench-forcefield"){
+            ForceField::benchmark();
+            return 0;
         }
     }
 
     Settings::instance()->setFullscreen(fullscreen);
 
+    // a benchmark or check must not take the sockets of a show running on the same machine
+    bool golden = !Settings::instance()->getGoldenDirectory().empty();
+    bool soak = !Settings::instance()->getReplayInput().empty();
+    bool benchmark = Settings::instance()->getBenchFrames() > 0 || golden || soak;
+    if(benchmark){
+        Settings::instance()->setBenchOut(ofFilePath::getAbsolutePath(Settings::instance()->getBenchOut(), false));
+        if(golden) Settings::instance()->setGoldenDirectory(ofFilePath::getAbsolutePath(Settings::instance()->getGoldenDirectory(), false));
+        if(soak){
+            Settings::instance()->setReplayInput(ofFilePath::getAbsolutePath(Settings::instance()->getReplayInput(), false));
+            Settings::instance()->setReplayReport(ofFilePath::getAbsolutePath(Settings::instance()->getReplayReport(), false));
+        }
+        Settings::instance()->setRecordInput("");
+        Settings::instance()->setFullscreen(false);
+        Settings::instance()->setCuePort(0);
+        Settings::instance()->setParameterSocket("");
+        Settings::instance()->setClusterRole("");
+        // nor resume the show's state or overwrite it
+        Settings::instance()->setSnapshotInterval(0);
+        Settings::instance()->setSnapshotMaxAge(0);
+    }
+
+    // kill -USR1 writes a trace of the last seconds of frames, see Trace
+    Trace::instance()->installSignalHandler();
+
+    // ofLog() and the scene manager messages are written by a background thread
+    AsyncLog::instance()->installChannel();
+
+#ifndef TARGET_RASPBERRY_PI
+    // llvmpipe under Xvfb on the build server, nothing needs to be seen
+    if(benchmark){
+        ofGLFWWindowSettings settings;
+        settings.width = 1000;
+        settings.height = 450;
+        settings.visible = false;
+        ofCreateWindow(settings);
+    }
+    else ofSetupOpenGL(1000, 450, OF_WINDOW);
+#else
     ofSetupOpenGL(1000, 450, OF_WINDOW);
-    ofRunApp(new ofApp());
+#endif
+    // the benchmark and golden checks report through the exit code
+    int status = ofRunApp(new ofApp());
+
+    InputLog::instance()->stopRecording();
+    AsyncLog::instance()->shutdown();
+    return status;
 }
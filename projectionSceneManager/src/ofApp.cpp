@@ -1,7 +1,23 @@
 #include "ofApp.h"
 
 void ofApp::setup(){
+    Trace::instance()->setThreadName("main");
+    // golden images and soak tests need the same particles and palettes on every run
+    if (!Settings::instance()->getGoldenDirectory().empty()) ofSeedRandom(GoldenFrames::seed);
+    else if (!Settings::instance()->getReplayInput().empty()) ofSeedRandom(SoakTest::seed);
 	ofBackground(0);
+    ofSetVerticalSync(true);
+
+    // Values for the runtime parameters the sources register below
+    Settings::instance()->loadParameters("settings.json");
+
+    // A cluster follower runs on the leader's clock from here on
+    Settings * settings = Settings::instance();
+    cluster.setup(ClusterSync::roleFromString(settings->getClusterRole()), settings->getClusterGroup(),
+                  settings->getClusterPort(), settings->getClusterNodeId(), settings->getClusterLog());
+
+    // Sources schedule their first timers during setup
+    TimerWheel::instance()->advance(cluster.now());
 
 	// Enable or disable audio for video sources globally
 	// Set this to false to save resources on the Raspberry Pi
@@ -15,17 +31,40 @@ void ofApp::setup(){
     bouncingBallsSource = new BouncingBallsSource();
     bouncingBallsSource->setup();
     piMapper.registerFboSource(bouncingBallsSource);
+    fboSources.push_back(bouncingBallsSource);
 
     movingRectSource = new MovingRectSource();
     movingRectSource->setup();
     piMapper.registerFboSource(movingRectSource);
+    fboSources.push_back(movingRectSource);
 
+    // More stations can run side by side, each with its own
+    // WaterfallGameConfig (name, button pin, size, counts)
     waterfallGameSource = new WaterfallGameSource();
     waterfallGameSource->setup();
     piMapper.registerFboSource(waterfallGameSource);
+    fboSources.push_back(waterfallGameSource);
+    attracting = false;
+
+    // Short looping clips are decoded once and then played from RAM.
+    // The budget is shared by all cached clips, least recently used ones are evicted first.
+    VideoFrameCache::instance()->setBudget(48 * 1024 * 1024);
+    gyroscopeLoopSource = new CachedVideoSource();
+    gyroscopeLoopSource->setup("sources/videos/spinning-gyroscope-during-astr.mp4", "Gyroscope Loop FBO Source", 640, 360, 0.5);
+    piMapper.registerFboSource(gyroscopeLoopSource);
+    fboSources.push_back(gyroscopeLoopSource);
 
     piMapper.setup();
 
+    // Surfaces are drawn by piMapper by default, press <9> to cycle through the batched modes
+    for (unsigned int i = 0; i < fboSources.size(); i++){
+        fboAtlas.add(fboSources[i]);
+    }
+    fboAtlas.allocate();
+    batching = false;
+    batchedPreset = -1;
+    setRenderMode(RENDER_PIMAPPER);
+    loadSurfaceLayout();
 
 	// The info layer is hidden by default, press <i> to toggle
 	// piMapper.showInfo();
@@ -37,16 +76,119 @@ void ofApp::setup(){
 
     //setup sceneManager to handle scene/present changes automatically
     sceneManager.setup("scenes.json", &piMapper);
+
+    // Remote cues from a lighting desk, see CueControlServer for the messages.
+    // Their parameters are the runtime parameters the sources registered.
+    sceneManager.setParameterCallback([](string source, string parameter, float value){
+        string error;
+        if (Settings::instance()->setParameter(source + ":" + parameter, ofToString(value), error)) return true;
+        ofLogError("ofApp") << error;
+        return false;
+    });
+    if (Settings::instance()->getCuePort() > 0) {
+        cueServer.setup(Settings::instance()->getCuePort(), &sceneManager.cues);
+    }
+    if (!Settings::instance()->getParameterSocket().empty()) {
+        parameterServer.setup(Settings::instance()->getParameterSocket());
+    }
+
+    // The benchmark steps through the presets itself, as fast as frames render
+    if (settings->getBenchFrames() > 0) {
+        ofSetVerticalSync(false);
+        sceneManager.pause();
+        benchmark.setup(&piMapper, settings->getBenchFrames(), settings->getBenchWarmupFrames(),
+                        settings->getBenchOut(), TimerWheel::instance()->now());
+    }
+    else if (!settings->getGoldenDirectory().empty()) {
+        sceneManager.pause();
+        vector<int> frames;
+        vector<string> list = ofSplitString(settings->getGoldenFrames(), ",", true, true);
+        for (unsigned int i = 0; i < list.size(); i++) frames.push_back(ofToInt(list[i]));
+        // the video decodes at its own pace, its frames differ from run to run
+        vector<ofx::piMapper::FboSource *> checked;
+        for (unsigned int i = 0; i < fboSources.size(); i++) {
+            if (fboSources[i] != gyroscopeLoopSource) checked.push_back(fboSources[i]);
+        }
+        golden.setup(checked, settings->getGoldenDirectory(), settings->getGoldenRecord(), frames, TimerWheel::instance()->now());
+    }
+    else if (!settings->getReplayInput().empty()) {
+        ofSetVerticalSync(false);
+        if (InputLog::instance()->load(settings->getReplayInput())) {
+            soak.setup(waterfallGameSource, &sceneManager.cues, settings->getReplaySessions(), settings->getReplaySpeed(),
+                       settings->getReplayReport(), TimerWheel::instance()->now());
+        }
+        else ofExit(1);
+    }
+    // buttons and cues of the show, for a soak test later
+    if (!settings->getRecordInput().empty()) InputLog::instance()->startRecording(settings->getRecordInput());
+
+    // After a crash or a watchdog restart the show goes on where it was
+    snapshotTimer = 0;
+    if (!settings->getSnapshotPath().empty()) resumeSnapshot();
+    if (!settings->getSnapshotPath().empty() && settings->getSnapshotInterval() > 0) {
+        snapshot.setup(settings->getSnapshotPath());
+        snapshotTimer = TimerWheel::instance()->scheduleEvery(settings->getSnapshotInterval(), [this](){ saveSnapshot(); });
+    }
 }
 
 void ofApp::update(){
-	piMapper.update();
+    // The one clock read of the frame, fires every timer that is due
+    // before the sources update and ask the wheel for the time.
+    // In a cluster the clock is slewed to the leader's first.
+    TRACE_ZONE("ofApp::update");
+    benchmark.beginFrame();
+    soak.beginFrame();
+    {
+        TRACE_ZONE("ClusterSync::update");
+        cluster.update(sceneManager);
+    }
+    // an accelerated soak test simulates the extra steps of the frame
+    // without drawing them
+    for (int step = 1; step < soak.getSpeed(); step++) {
+        TRACE_ZONE("SoakTest::step");
+        soak.step();
+        TimerWheel::instance()->advance(soak.now());
+        sceneManager.update();
+        for (unsigned int i = 0; i < fboSources.size(); i++) fboSources[i]->update();
+    }
+    soak.step();
+    {
+        TRACE_ZONE("TimerWheel::advance");
+        uint64_t now = cluster.now();
+        if (benchmark.isRunning()) now = benchmark.now();
+        else if (golden.isRunning()) now = golden.now();
+        else if (soak.isRunning()) now = soak.now();
+        else if (cluster.takeStep()) rebaseClock(now);
+        TimerWheel::instance()->advance(now);
+    }
+    // remote cues go first so a preset change shows in this frame
     sceneManager.update();
+    parameterServer.update();
+    if (golden.isRunning()) golden.step();
+    else {
+        TRACE_ZONE("ofxPiMapper::update");
+        piMapper.update();
+    }
+    updateSurfaceBatching();
+    updateAttractMode();
+
+    // the key or SIGUSR1 asked for the last seconds of zones
+    if (Trace::instance()->dumpRequested()) Trace::instance()->dump();
 }
 
 void ofApp::draw(){
+    TRACE_ZONE("ofApp::draw");
+    if (golden.isRunning()) return;
+    benchmark.beginDraw();
   //  dummyObjects.draw(200,200);
-    piMapper.draw();
+    if (batching) {
+        fboAtlas.render();
+        surfaceBatcher.draw();
+    }
+    else piMapper.draw();
+    benchmark.endDraw();
+    soak.endFrame();
+    DrawStats::instance()->frame();
 }
 
 void ofApp::keyPressed(int key){
@@ -56,23 +198,60 @@ void ofApp::keyPressed(int key){
             int targetScene = piMapper.getActivePresetIndex() - 1;
             if (targetScene<0) targetScene = piMapper.getNumPresets()-1;
             piMapper.setPreset(targetScene);
-            cout << "Switched to preset: " << piMapper.getActivePresetIndex() << endl;
-        } else cout << "only one preset available" << endl;
+            logNotice("Switched to preset: {}", piMapper.getActivePresetIndex());
+        } else logNotice("only one preset available");
     }
     //press 6 to go to next preset (scene)
     else if (key=='6') {
         if (piMapper.getNumPresets()>1){
             piMapper.setNextPreset();
-            cout << "Switched to preset: " << piMapper.getActivePresetIndex() << endl;
-        } else cout << "only one preset available" << endl;
+            logNotice("Switched to preset: {}", piMapper.getActivePresetIndex());
+        } else logNotice("only one preset available");
     }
     else if (key == '7'){
         piMapper.cloneActivePreset();
         piMapper.setPreset(piMapper.getNumPresets()-1);
-        cout << "Cloned and switched to preset: " << piMapper.getActivePresetIndex() << endl;
+        logNotice("Cloned and switched to preset: {}", piMapper.getActivePresetIndex());
+        loadSurfaceLayout();
+    }
+    //press 0 to print the cluster role and clock offsets, the remote cue latency,
+    //the frame rate and cpu use of the game while played and in attract mode
+    //and the snapshot timings
+    else if (key == '0'){
+        ofLogNotice("ClusterSync") << cluster.getStatusString();
+        ofLogNotice("SceneManager") << sceneManager.getCueStatsString();
+        logNotice("{}", waterfallGameSource->getLoadString());
+        ofLogNotice("StateSnapshot") << snapshot.getStatsString();
+    }
+    //press 8 to print video cache memory use and hit rate
+    else if (key == '8'){
+        ofLogNotice("VideoFrameCache") << VideoFrameCache::instance()->getStatsString();
+    }
+    //press ` to write a trace of the last seconds of frames to data/traces
+    else if (key == '`'){
+        Trace::instance()->requestDump();
+    }
+    //press - to log draw calls and state changes per source every few seconds, again to stop
+    else if (key == '-'){
+        DrawStats::instance()->setEnabled(!DrawStats::isEnabled());
+        logNotice("draw statistics {}", DrawStats::isEnabled() ? "on" : "off");
+    }
+    //press 9 to cycle surface drawing: piMapper -> batched -> batched from a single atlas texture
+    else if (key == '9'){
+        if (renderMode == RENDER_PIMAPPER) setRenderMode(RENDER_BATCHED);
+        else if (renderMode == RENDER_BATCHED) setRenderMode(RENDER_BATCHED_ATLAS);
+        else setRenderMode(RENDER_PIMAPPER);
+    }
+    //any other key while editing may change surfaces that are not saved yet
+    else if (piMapper.getMode() != ofx::piMapper::PRESENTATION_MODE
+             && key != '1' && key != '2' && key != '3' && key != '4' && key != 'i' && key != 's'){
+        layoutStale = true;
     }
 
 	piMapper.keyPressed(key);
+
+    //piMapper writes ofxpimapper.xml on <s>, pick up the edited surfaces
+    if (key == 's') loadSurfaceLayout();
 }
 
 void ofApp::keyReleased(int key){
@@ -88,5 +267,126 @@ void ofApp::mouseReleased(int x, int y, int button){
 }
 
 void ofApp::mouseDragged(int x, int y, int button){
+    if (piMapper.getMode() != ofx::piMapper::PRESENTATION_MODE) layoutStale = true;
 	piMapper.mouseDragged(x, y, button);
 }
+
+//--------------------------------------------------------------
+// Batched surface drawing
+
+void ofApp::loadSurfaceLayout(){
+    surfaceLayout.load("ofxpimapper.xml");
+    if (renderMode != RENDER_PIMAPPER) addImageSources();
+    surfaceBatcher.markDirty();
+    layoutStale = false;
+}
+
+void ofApp::setRenderMode(SurfaceRenderMode mode){
+    renderMode = mode;
+    surfaceBatcher.clearTextures();
+    for (unsigned int i = 0; i < fboSources.size(); i++){
+        string name = fboSources[i]->getName();
+        if (mode == RENDER_BATCHED_ATLAS) surfaceBatcher.setTexture(name, &fboAtlas.getTexture(), fboAtlas.getTexRegion(name), fboAtlas.getTexClamp(name));
+        else surfaceBatcher.setTexture(name, fboSources[i]->getTexture());
+    }
+    if (mode != RENDER_PIMAPPER) addImageSources();
+    if (mode == RENDER_PIMAPPER) logNotice("Surfaces drawn by piMapper");
+    else if (mode == RENDER_BATCHED) logNotice("Surfaces batched per source texture");
+    else logNotice("Surfaces batched through the FBO atlas");
+}
+
+// Our own copy of every image the layout uses, from where piMapper loads
+// them. Each is loaded once and stays, the images do not change.
+void ofApp::addImageSources(){
+    for (int p = 0; p < surfaceLayout.getNumPresets(); p++) {
+        vector<SurfaceDef> & surfaces = surfaceLayout.getSurfaces(p);
+        for (unsigned int i = 0; i < surfaces.size(); i++) {
+            if (surfaces[i].sourceType != "image") continue;
+            string name = surfaces[i].sourceName;
+            if (imageSources.find(name) == imageSources.end()) {
+                if (!imageSources[name].load("sources/images/" + name)) {
+                    logWarning("image source {} not found, presets using it are drawn by piMapper", name);
+                    continue;
+                }
+            }
+            if (imageSources[name].isAllocated()) surfaceBatcher.setTexture(name, &imageSources[name].getTexture());
+        }
+    }
+}
+
+void ofApp::updateSurfaceBatching(){
+    int preset = piMapper.getActivePresetIndex();
+
+    // only take over drawing while nobody is editing surfaces and the
+    // layout on disk matches what piMapper has in memory
+    bool useBatching = renderMode != RENDER_PIMAPPER
+        && piMapper.getMode() == ofx::piMapper::PRESENTATION_MODE
+        && !layoutStale
+        && preset < surfaceLayout.getNumPresets()
+        && surfaceBatcher.canDraw(surfaceLayout.getSurfaces(preset));
+
+    if (useBatching && (surfaceBatcher.isDirty() || preset != batchedPreset)){
+        surfaceBatcher.build(surfaceLayout.getSurfaces(preset));
+        batchedPreset = preset;
+        logNotice("{} surfaces in {} draw calls", surfaceBatcher.getNumSurfaces(), surfaceBatcher.getNumBatches());
+    }
+
+    bool useAtlas = useBatching && renderMode == RENDER_BATCHED_ATLAS;
+    if (useAtlas != fboAtlas.isEnabled()) fboAtlas.setEnabled(useAtlas);
+    batching = useBatching;
+}
+
+//--------------------------------------------------------------
+// Attract mode
+
+void ofApp::updateAttractMode(){
+    // a benchmark or soak test measures the show at full rate. Any other
+    // source on screen keeps it too, an idle game then only ticks slower.
+    bool attract = presetShowsOnlyIdleGames() && !benchmark.isRunning() && !golden.isRunning() && !soak.isRunning();
+    if (attract == attracting) return;
+    attracting = attract;
+    // back to full rate on the frame the button woke the game, vsync caps it at the display rate
+    ofSetFrameRate(attract ? Settings::instance()->getAttractFrameRate() : 60);
+}
+
+// From the surfaces of the active preset, as far as the layout on disk
+// still matches piMapper's. An empty preset keeps the full rate.
+bool ofApp::presetShowsOnlyIdleGames(){
+    int preset = piMapper.getActivePresetIndex();
+    if (!waterfallGameSource->isAttracting() || layoutStale || preset < 0 || preset >= surfaceLayout.getNumPresets()) return false;
+    vector<SurfaceDef> & surfaces = surfaceLayout.getSurfaces(preset);
+    for (unsigned int i = 0; i < surfaces.size(); i++) {
+        if (surfaces[i].sourceName != waterfallGameSource->getName()) return false;
+    }
+    return !surfaces.empty();
+}
+
+//--------------------------------------------------------------
+// Snapshots
+
+// Runs from the timer wheel, between the sources' updates of two frames
+void ofApp::saveSnapshot(){
+    TRACE_ZONE("ofApp::saveSnapshot");
+    SnapshotWriter & out = snapshot.begin();
+    sceneManager.saveState(out);
+    waterfallGameSource->saveState(out);
+    snapshot.commit();
+}
+
+// A follower stepped to the leader's clock, which may be days ahead or
+// behind. Walking the wheel through that gap would fire every scene and
+// game timer in between within one frame.
+void ofApp::rebaseClock(uint64_t now){
+    int64_t delta = TimerWheel::instance()->rebase(now);
+    sceneManager.rebase(delta);
+    waterfallGameSource->rebase(delta);
+}
+
+void ofApp::resumeSnapshot(){
+    int maxAge = Settings::instance()->getSnapshotMaxAge();
+    if (maxAge <= 0) return;
+    SnapshotReader in;
+    if (!snapshot.load(Settings::instance()->getSnapshotPath(), (uint64_t)maxAge * 1000, in)) return;
+    sceneManager.restoreState(in);
+    waterfallGameSource->restoreState(in);
+}
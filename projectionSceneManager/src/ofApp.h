@@ -6,8 +6,23 @@
 #include "BouncingBallsSource.h"
 #include "MovingRectSource.h"
 #include "WaterfallGameSource.h"
+#include "CachedVideoSource.h"
 #include "VideoSource.h"
 #include "SceneManager.h"
+#include "TimerWheel.h"
+#include "AsyncLog.h"
+#include "Trace.h"
+#include "DrawStats.h"
+#include "RenderBenchmark.h"
+#include "GoldenFrames.h"
+#include "SoakTest.h"
+#include "InputLog.h"
+#include "ClusterSync.h"
+#include "StateSnapshot.h"
+#include "ParameterServer.h"
+#include "FboAtlas.h"
+#include "SurfaceLayout.h"
+#include "SurfaceBatcher.h"
 
 class ofApp : public ofBaseApp {
 	public:
@@ -22,6 +37,22 @@ class ofApp : public ofBaseApp {
 		void mouseReleased(int x, int y, int button);
 		void mouseDragged(int x, int y, int button);
 
+        enum SurfaceRenderMode {
+            RENDER_PIMAPPER,
+            RENDER_BATCHED,
+            RENDER_BATCHED_ATLAS
+        };
+
+        void loadSurfaceLayout();
+        void setRenderMode(SurfaceRenderMode mode);
+        void addImageSources();
+        void updateSurfaceBatching();
+        void updateAttractMode();
+        bool presetShowsOnlyIdleGames();
+        void saveSnapshot();
+        void resumeSnapshot();
+        void rebaseClock(uint64_t now);
+
 		ofxPiMapper piMapper;
 
 		// By using a custom source that is derived from FboSource
@@ -29,7 +60,41 @@ class ofApp : public ofBaseApp {
         BouncingBallsSource * bouncingBallsSource;
         MovingRectSource * movingRectSource;
         WaterfallGameSource * waterfallGameSource;
+        CachedVideoSource * gyroscopeLoopSource;
+        vector<ofx::piMapper::FboSource *> fboSources;
       //  ofImage dummyObjects;
 
         SceneManager sceneManager;
+        ClusterSync cluster;
+        CueControlServer cueServer;
+        ParameterServer parameterServer;
+
+        // written in the background every few seconds, read back on start
+        StateSnapshot snapshot;
+        TimerWheel::TimerId snapshotTimer;
+
+        // the whole app renders slower while the preset only shows games
+        // nobody plays
+        bool attracting;
+
+        // --bench-render, runs on a fixed clock and quits when done
+        RenderBenchmark benchmark;
+        // --golden-record / --golden-check, draws the sources without piMapper
+        GoldenFrames golden;
+        // --replay-input, replays recorded buttons and cues session after session
+        SoakTest soak;
+
+        // Batched modes: while in presentation mode we draw the surfaces
+        // ourselves, one draw call per texture. With the atlas all FBO
+        // sources share a single texture and therefore a single draw call.
+        // Image sources are loaded a second time for it, see SurfaceBatcher
+        // for video sources.
+        FboAtlas fboAtlas;
+        SurfaceLayout surfaceLayout;
+        SurfaceBatcher surfaceBatcher;
+        SurfaceRenderMode renderMode;
+        bool batching;
+        bool layoutStale;
+        int batchedPreset;
+        map<string, ofImage> imageSources;
 };